@@ -0,0 +1,166 @@
+#include "demolib_compensated.h"
+#include "demolib_magnetic.h"
+#include "demolib_self_energy.h"
+#include "compensated.h"
+#include "kinematics.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace demolib;
+
+// Reference sum of the terms in quadruple precision when the compiler
+// supports it (extended precision otherwise)
+#ifdef __SIZEOF_FLOAT128__
+using extended_t = __float128;
+#else
+using extended_t = long double;
+#endif
+
+complex_t referenceSum(std::vector<complex_t> const &terms)
+{
+    extended_t re = 0, im = 0;
+    for (auto const &t : terms) {
+        re += t.real();
+        im += t.imag();
+    }
+    return {double(re), double(im)};
+}
+
+complex_t naiveSum(std::vector<complex_t> const &terms)
+{
+    complex_t sum = 0;
+    for (auto const &t : terms)
+        sum += t;
+    return sum;
+}
+
+int main(int argc, char const *argv[]) {
+
+    // Number of points of the p^2 scan and of repetitions for the timing
+    std::size_t const nPoints = (argc > 1) ? std::atoi(argv[1]) : 200;
+    std::size_t const nRepeat = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+    param_t params;
+    double alpha = 1./137;
+    double m = 0.1;
+    params.e = std::sqrt(4*M_PI*alpha);
+    params.m_mu = m;
+    params.Finite = 1;
+    setlambda(0);
+
+    std::cout << "######################################\n";
+    std::cout << "####  COMPENSATED SUMMATION\n";
+    std::cout << "######################################\n\n";
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Accuracy
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // Squared self-energy for p^2 from far below to far above m^2, the
+    // terms of each point are evaluated once and summed naively and 
+    // with compensation
+    std::vector<std::vector<complex_t>> terms(nPoints);
+    double maxNaive = 0, maxCompensated = 0;
+    for (std::size_t i = 0; i != nPoints; ++i) {
+        param_t local = params;
+        demo::setTwoPointKinematics(
+                local, demo::logGrid(i, nPoints, 1e-6*m*m, 1e4*m*m));
+        terms[i].resize(mu_self_e_squared_expanded_size);
+        mu_self_e_squared_expanded_terms(local, terms[i].data());
+
+        complex_t const ref = referenceSum(terms[i]);
+        double const scale = std::max(std::abs(ref), 1e-300);
+        complex_t const compensated 
+            = demo::compensatedSum(terms[i].begin(), terms[i].end());
+        maxNaive = std::max(
+                maxNaive, std::abs(naiveSum(terms[i]) - ref) / scale);
+        maxCompensated = std::max(
+                maxCompensated, std::abs(compensated - ref) / scale);
+    }
+    std::cout << "Squared self-energy, " << mu_self_e_squared_expanded_size
+              << " terms, " << nPoints << " values of p^2\n";
+    std::cout << "Max relative error, naive sum       = " << maxNaive << '\n';
+    std::cout << "Max relative error, compensated sum = " << maxCompensated 
+              << "\n\n";
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Cost
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // Summation alone, on the terms evaluated above
+    auto timeSum = [&](auto &&sum) {
+        complex_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r != nRepeat; ++r)
+            for (auto const &t : terms)
+                total += sum(t);
+        std::chrono::duration<double> const elapsed 
+            = std::chrono::steady_clock::now() - start;
+        // Printed so that the loop is not optimized away
+        std::cout << "    (total " << total.real() << ")\n";
+        return elapsed.count() / (nRepeat * nPoints);
+    };
+    double const tNaive = timeSum(naiveSum);
+    double const tCompensated = timeSum([](std::vector<complex_t> const &t) {
+        return demo::compensatedSum(t.begin(), t.end());
+    });
+    double const tReference = timeSum(referenceSum);
+    std::cout << "Time per sum, naive          = " << tNaive << " s\n";
+    std::cout << "Time per sum, compensated    = " << tCompensated << " s\n";
+    std::cout << "Time per sum, quad precision = " << tReference << " s\n\n";
+
+    // Full evaluation, generated sum against terms summed with 
+    // compensation
+    demo::setTwoPointKinematics(params, 2*m*m);
+    auto timeCall = [&](auto &&f) {
+        auto start = std::chrono::steady_clock::now();
+        complex_t total = 0;
+        for (std::size_t r = 0; r != nRepeat; ++r)
+            total += f(params);
+        std::chrono::duration<double> const elapsed 
+            = std::chrono::steady_clock::now() - start;
+        std::cout << "    (total " << total.real() << ")\n";
+        return elapsed.count() / nRepeat;
+    };
+    double const tGenerated  = timeCall(mu_self_e_squared);
+    double const tTermByTerm = timeCall(mu_self_e_squared_expanded);
+    // Evaluation of the terms alone, one call of a generated function 
+    // per term (see library_groups.h)
+    double const tTerms = timeCall([](param_t const &p) {
+        complex_t t[mu_self_e_squared_expanded_size];
+        mu_self_e_squared_expanded_terms(p, t);
+        return t[0];
+    });
+    std::size_t const nTerms = mu_self_e_squared_expanded_size;
+    std::cout << "Time per call, mu_self_e_squared          = " 
+              << tGenerated << " s\n";
+    std::cout << "Time per call, mu_self_e_squared_expanded = " 
+              << tTermByTerm << " s\n";
+    std::cout << "    evaluation of the " << nTerms << " terms    = " 
+              << tTerms << " s (" << tTerms / nTerms << " s per term)\n";
+    std::cout << "Overhead of the term by term evaluation   = "
+              << (tTermByTerm - tGenerated) / nTerms << " s per term\n\n";
+
+    // Same value for the expanded (g-2)
+    demo::setVertexKinematics(params, m);
+    std::cout << "(g-2)µ [expanded, compensated] = " 
+              << -8*m/params.e * mu_magnetic_vertex_expanded(params).real() 
+              << std::endl;
+    std::cout << "(should be equal to " 
+              << -8*m/params.e * mu_magnetic_vertex_eval(params).real() 
+              << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "demolib_fwd.h"
+#include "kinematics.h"
+#include "perf_counters.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace demolib;
+
+struct Function {
+    char const *name;
+    complex_t (*f)(param_t const &);
+};
+
+int main(int argc, char const *argv[]) {
+
+    // Number of calls per function
+    std::size_t const nCalls = (argc > 1) ? std::atoi(argv[1]) : 10000;
+
+    param_t params;
+    double alpha = 1./137;
+    double m = 0.1;
+    params.e = std::sqrt(4*M_PI*alpha);
+    params.m_mu = m;
+    demo::setTwoPointKinematics(params, 2*m*m);
+    demo::setVertexKinematics(params, m);
+    params.Finite = 1;
+    setlambda(0);
+
+    Function const functions[] = {
+        {"mu_self_e_mterm",           mu_self_e_mterm},
+        {"mu_self_e_pterm",           mu_self_e_pterm},
+        {"mu_self_e_squared",         mu_self_e_squared},
+        {"mu_magnetic_vertex",        mu_magnetic_vertex},
+        {"mu_magnetic_vertex_eval",   mu_magnetic_vertex_eval},
+        {"mu_magnetic_vertex_simpli", mu_magnetic_vertex_simpli},
+        {"photon_self_e_gterm",       photon_self_e_gterm},
+        {"mu_vertex_vector_q2",       mu_vertex_vector_q2},
+        {"mu_vertex_magnetic_q2",     mu_vertex_magnetic_q2}
+    };
+
+    std::cout << "######################################\n";
+    std::cout << "####  PERFORMANCE COUNTERS PER FUNCTION\n";
+    std::cout << "######################################\n\n";
+    std::cout << nCalls << " calls per function, values per call\n\n";
+
+    // The loop integrals are found in the cache of LoopTools after the 
+    // first call: the counters measure the generated code itself
+    demo::PerfCounters counters;
+    for (auto const &function : functions) {
+        complex_t total = function.f(params);
+        counters.start();
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i != nCalls; ++i)
+            total += function.f(params);
+        std::chrono::duration<double> const elapsed 
+            = std::chrono::steady_clock::now() - start;
+        demo::PerfCounts const counts = counters.stop();
+
+        std::cout << function.name << " (" << total.real() << ")\n";
+        std::cout << "    time          " << elapsed.count() / nCalls 
+                  << " s\n";
+        if (!counts.available()) {
+            std::cout << "    counters unavailable\n";
+            continue;
+        }
+        std::cout << "    instructions  " 
+                  << double(counts.instructions()) / nCalls << '\n';
+        std::cout << "    cycles        " 
+                  << double(counts.cycles()) / nCalls << '\n';
+        std::cout << "    IPC           " << counts.ipc() << '\n';
+        std::cout << "    cache misses  " 
+                  << double(counts.cacheMisses()) / nCalls << " ("
+                  << counts.cacheMissesPerKiloInstruction() 
+                  << " per 1000 instructions)\n";
+        std::cout << "    branch misses " 
+                  << double(counts.branchMisses()) / nCalls << '\n';
+    }
+
+    return 0;
+}
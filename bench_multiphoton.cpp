@@ -0,0 +1,81 @@
+/*
+ * Benchmark of the symbolic tree-level amplitude calculation for
+ *     mu^- mu^+ -> n gamma
+ * in the QED model of main.cpp, as a function of the number of photons.
+ *
+ *  For each n the program measures the time taken by 
+ *  computeAmplitude() and computeSquaredAmplitude() and reports the
+ *  number of Feynman diagrams (n! for n photons on a single muon line).
+ *
+ *  Each n is computed in its own process (see runIsolated() in 
+ *  execution.h): the abbreviations created for one multiplicity are 
+ *  released before the next one. The memory reported for each n is 
+ *  the growth of the resident memory of that process during its 
+ *  calculation, the model inherited from the parent is not included.
+ *
+ *  The numerical counterpart, a Berends-Giele recursion whose cost
+ *  grows as n*2^n instead of n*n!, is benchmarked by 
+ *  bench_multiphoton_numeric.cpp.
+ *
+ *  Usage: ./bench_multiphoton [nMax]
+ */
+#include "marty.h"
+#include "execution.h"
+#include "qed_model.h"
+
+#include <chrono>
+#include <iomanip>
+
+using namespace std;
+using namespace csl;
+using namespace mty;
+
+int main(int argc, char const *argv[])
+{
+    size_t const nMax = (argc > 1) ? atoi(argv[1]) : 5;
+
+    // Same QED model as in main.cpp, see qed_model.h
+    Model model;
+    demo::buildQedModel(model);
+
+    model.refresh();
+
+    cout << setw(3) << "n" 
+         << setw(12) << "diagrams" 
+         << setw(18) << "amplitude (s)" 
+         << setw(18) << "squared (s)"
+         << setw(16) << "new memory (MB)" << '\n';
+    for (size_t n = 2; n <= nMax; ++n) {
+        // Number of diagrams, amplitude and squared amplitude times
+        demo::SharedArray<double> results(3);
+        long const memory = demo::runIsolated([&]() {
+            vector<Insertion> insertions = {Incoming("mu"), Incoming(AntiPart("mu"))};
+            for (size_t i = 0; i != n; ++i)
+                insertions.push_back(Outgoing("A"));
+
+            auto start = chrono::steady_clock::now();
+            Amplitude amplitude = model.computeAmplitude(TreeLevel, insertions);
+            chrono::duration<double> const tAmplitude 
+                = chrono::steady_clock::now() - start;
+
+            start = chrono::steady_clock::now();
+            Expr squared = model.computeSquaredAmplitude(amplitude);
+            chrono::duration<double> const tSquared 
+                = chrono::steady_clock::now() - start;
+
+            results[0] = amplitude.getDiagrams().size();
+            results[1] = tAmplitude.count();
+            results[2] = tSquared.count();
+        });
+
+        // Peak resident memory of the calculation above what the 
+        // process inherited from this one
+        cout << setw(3) << n 
+             << setw(12) << results[0]
+             << setw(18) << results[1]
+             << setw(18) << results[2]
+             << setw(16) << memory / 1024. << endl;
+    }
+
+    return 0;
+}
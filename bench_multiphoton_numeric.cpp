@@ -0,0 +1,128 @@
+/*
+ * Benchmark of the numerical Berends-Giele recursion of 
+ * berends_giele.h for mu^- mu^+ -> n gamma, compared to the sum over 
+ * the n! Feynman diagrams.
+ *
+ *  The normalization is first checked for n = 2 against the analytic
+ *  result of mu^- mu^+ -> gamma gamma. Then for each n the program 
+ *  checks on one phase-space point that both methods agree and that 
+ *  the amplitude vanishes when the polarization of a photon is 
+ *  replaced by its momentum (Ward identity), then times the evaluation
+ *  of the amplitude for all the spin and polarization configurations.
+ *
+ *  Usage: ./bench_multiphoton_numeric [nMax [nDiagramsMax]]
+ */
+#include "berends_giele.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace demo;
+
+// Sum of |M|^2 over all spins and polarizations
+template<class AmplitudeFunc>
+double squaredAmplitude(MultiPhotonProcess const &proc, AmplitudeFunc &&amplitude)
+{
+    size_t const n = proc.k.size();
+    double sum = 0;
+    vector<Polarization> eps(n);
+    for (int s1 = 0; s1 != 2; ++s1)
+    for (int s2 = 0; s2 != 2; ++s2) {
+        Spinor const u1 = uSpinor(proc.p1, proc.m, s1);
+        Spinor const v2 = vSpinor(proc.p2, proc.m, s2);
+        for (size_t hel = 0; hel != (size_t(1) << n); ++hel) {
+            for (size_t i = 0; i != n; ++i)
+                eps[i] = photonPolarization(proc.k[i], (hel >> i & 1) ? 1 : -1);
+            sum += norm(amplitude(proc, u1, v2, eps));
+        }
+    }
+    return sum;
+}
+
+// Analytic sum of |M|^2 over all spins and polarizations for n = 2,
+// Peskin & Schroeder eq. 5.105 (which gives 1/4 of the sum) with p the
+// momentum of the incoming mu^-
+double squaredAmplitudeTwoPhotons(MultiPhotonProcess const &proc)
+{
+    double const pk1 = dot(proc.p1, proc.k[0]);
+    double const pk2 = dot(proc.p1, proc.k[1]);
+    double const m2  = proc.m * proc.m;
+    double const inv = 1/pk1 + 1/pk2;
+    double const e4  = std::pow(proc.e, 4);
+    return 8*e4 * (pk2/pk1 + pk1/pk2 + 2*m2*inv - m2*m2*inv*inv);
+}
+
+template<class Func>
+double timeIt(Func &&f, int nRepeat)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i != nRepeat; ++i)
+        f();
+    chrono::duration<double> const elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / nRepeat;
+}
+
+int main(int argc, char const *argv[])
+{
+    size_t const nMax          = (argc > 1) ? atoi(argv[1]) : 10;
+    size_t const nDiagramsMax  = (argc > 2) ? atoi(argv[2]) : 7;
+    double const alpha = 1./137;
+    double const e     = sqrt(4*M_PI*alpha);
+    double const m     = 0.1;
+    double const sqrtS = 10;
+
+    mt19937 gen(42);
+
+    // Independent check of the normalization (vertex, propagator and
+    // spinors), close to threshold where the mass terms matter
+    {
+        MultiPhotonProcess const proc = randomProcess(2, e, m, 3*m, gen);
+        double const M2Recursion = squaredAmplitude(proc, multiPhotonAmplitude);
+        double const M2Analytic  = squaredAmplitudeTwoPhotons(proc);
+        cout << "n = 2: sum |M|^2 = " << M2Recursion 
+             << " (should be equal to " << M2Analytic << ")\n\n";
+    }
+
+    cout << setw(3) << "n" 
+         << setw(15) << "recursion (s)" 
+         << setw(15) << "diagrams (s)" 
+         << setw(15) << "rel. diff" 
+         << setw(15) << "Ward" << '\n';
+    for (size_t n = 2; n <= nMax; ++n) {
+        MultiPhotonProcess const proc = randomProcess(n, e, m, sqrtS, gen);
+
+        double M2Recursion = 0;
+        double const tRecursion = timeIt([&]() {
+            M2Recursion = squaredAmplitude(proc, multiPhotonAmplitude);
+        }, (n < 8) ? 10 : 1);
+        cout << setw(3) << n << setw(15) << tRecursion;
+        if (n <= nDiagramsMax) {
+            double M2Diagrams = 0;
+            double const tDiagrams = timeIt([&]() {
+                M2Diagrams = squaredAmplitude(proc, multiPhotonAmplitudeDiagrams);
+            }, 1);
+            cout << setw(15) << tDiagrams 
+                 << setw(15) << abs(M2Recursion - M2Diagrams) / M2Diagrams;
+        }
+        else {
+            cout << setw(15) << "-" << setw(15) << "-";
+        }
+
+        // Ward identity: eps_1 -> k_1 must give a vanishing amplitude,
+        // compared to the typical size of the amplitude
+        Spinor const u1 = uSpinor(proc.p1, m, 0);
+        Spinor const v2 = vSpinor(proc.p2, m, 0);
+        vector<Polarization> eps(n);
+        for (size_t i = 0; i != n; ++i)
+            eps[i] = photonPolarization(proc.k[i], 1);
+        for (int mu = 0; mu != 4; ++mu)
+            eps[0][mu] = proc.k[0][mu];
+        double const ward = abs(multiPhotonAmplitude(proc, u1, v2, eps)) 
+            / (proc.k[0][0] * sqrt(M2Recursion));
+        cout << setw(15) << ward << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * Numerical evaluation of the tree-level amplitude
+ *     mu^-(p1) mu^+(p2) -> gamma(k1) ... gamma(kn)
+ * in QED with a Berends-Giele recursion.
+ *
+ * The vertex and the propagator are written by hand below, they are not
+ * read from MARTY. They follow the conventions of the QED model of
+ * main.cpp (compare with Show(model.getFeynmanRules())):
+ *  - the mu-mu-A vertex         -i*e*Q*gamma^mu, with Q = -1
+ *  - the muon propagator        i*(pslash + m) / (p^2 - m^2)
+ * bench_multiphoton_numeric.cpp checks the normalization against the
+ * analytic result for n = 2.
+ *
+ * All the photons are attached to the single muon line. Instead of
+ * summing the n! orderings of the photons along the line, the recursion
+ * builds the off-shell muon currents J(S) for all subsets S of photons,
+ *     J({})  = u(p1)
+ *     J(S)   = S_F(p1 - K_S) * sum_{i in S} V(eps_i) J(S - {i})
+ * with K_S the sum of the photon momenta in S, reusing each current for
+ * all the orderings sharing the same subset. The cost is n*2^n products
+ * of a Dirac matrix with a spinor instead of n*n!.
+ *
+ * The header is standalone (no MARTY dependency).
+ */
+#ifndef DEMO_BERENDS_GIELE_H_INCLUDED
+#define DEMO_BERENDS_GIELE_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace demo {
+
+    using complex_t = std::complex<double>;
+
+    // Four-vector with metric (+,-,-,-)
+    template<class T>
+    using FourVector = std::array<T, 4>;
+
+    using Momentum     = FourVector<double>;
+    using Polarization = FourVector<complex_t>;
+    using Spinor       = std::array<complex_t, 4>;
+    using DiracMatrix  = std::array<std::array<complex_t, 4>, 4>;
+
+    inline double dot(Momentum const &p, Momentum const &q)
+    {
+        return p[0]*q[0] - p[1]*q[1] - p[2]*q[2] - p[3]*q[3];
+    }
+
+    inline Momentum operator+(Momentum const &p, Momentum const &q)
+    {
+        return {p[0]+q[0], p[1]+q[1], p[2]+q[2], p[3]+q[3]};
+    }
+
+    inline Momentum operator-(Momentum const &p, Momentum const &q)
+    {
+        return {p[0]-q[0], p[1]-q[1], p[2]-q[2], p[3]-q[3]};
+    }
+
+    // Gamma matrices in the Dirac representation
+    inline std::array<DiracMatrix, 4> const &gammaMatrices()
+    {
+        static std::array<DiracMatrix, 4> const gamma = []() {
+            complex_t const I(0, 1);
+            std::array<DiracMatrix, 4> g {};
+            // gamma^0 = diag(1, 1, -1, -1)
+            g[0][0][0] = g[0][1][1] = 1;
+            g[0][2][2] = g[0][3][3] = -1;
+            // gamma^i = ((0, sigma^i), (-sigma^i, 0))
+            std::array<std::array<std::array<complex_t, 2>, 2>, 3> sigma {{
+                {{ {0, 1}, {1, 0} }},
+                {{ {0, -I}, {I, 0} }},
+                {{ {1, 0}, {0, -1} }}
+            }};
+            for (int i = 0; i != 3; ++i)
+                for (int a = 0; a != 2; ++a)
+                    for (int b = 0; b != 2; ++b) {
+                        g[i+1][a][b+2] =  sigma[i][a][b];
+                        g[i+1][a+2][b] = -sigma[i][a][b];
+                    }
+            return g;
+        }();
+        return gamma;
+    }
+
+    // vslash = gamma^mu v_mu
+    template<class T>
+    DiracMatrix slash(FourVector<T> const &v)
+    {
+        auto const &g = gammaMatrices();
+        DiracMatrix res {};
+        for (int a = 0; a != 4; ++a)
+            for (int b = 0; b != 4; ++b)
+                res[a][b] = g[0][a][b]*v[0] - g[1][a][b]*v[1]
+                          - g[2][a][b]*v[2] - g[3][a][b]*v[3];
+        return res;
+    }
+
+    inline Spinor operator*(DiracMatrix const &M, Spinor const &s)
+    {
+        Spinor res {};
+        for (int a = 0; a != 4; ++a)
+            for (int b = 0; b != 4; ++b)
+                res[a] += M[a][b] * s[b];
+        return res;
+    }
+
+    inline Spinor operator+(Spinor const &s, Spinor const &t)
+    {
+        return {s[0]+t[0], s[1]+t[1], s[2]+t[2], s[3]+t[3]};
+    }
+
+    // \bar{s} t = s^dagger gamma^0 t
+    inline complex_t barProduct(Spinor const &s, Spinor const &t)
+    {
+        return std::conj(s[0])*t[0] + std::conj(s[1])*t[1]
+             - std::conj(s[2])*t[2] - std::conj(s[3])*t[3];
+    }
+
+    // Dirac spinors with spin s = 0, 1 along z, normalized to 2m
+    inline Spinor uSpinor(Momentum const &p, double m, int s)
+    {
+        double const N = std::sqrt(p[0] + m);
+        complex_t const chi0 = (s == 0) ? 1 : 0;
+        complex_t const chi1 = (s == 0) ? 0 : 1;
+        complex_t const pm(p[1], -p[2]), pp(p[1], p[2]);
+        // sigma.p chi / (E + m)
+        complex_t const l0 = (p[3]*chi0 + pm*chi1) / (p[0] + m);
+        complex_t const l1 = (pp*chi0 - p[3]*chi1) / (p[0] + m);
+        return {N*chi0, N*chi1, N*l0, N*l1};
+    }
+
+    inline Spinor vSpinor(Momentum const &p, double m, int s)
+    {
+        double const N = std::sqrt(p[0] + m);
+        complex_t const eta0 = (s == 0) ? 0 : 1;
+        complex_t const eta1 = (s == 0) ? 1 : 0;
+        complex_t const pm(p[1], -p[2]), pp(p[1], p[2]);
+        complex_t const u0 = (p[3]*eta0 + pm*eta1) / (p[0] + m);
+        complex_t const u1 = (pp*eta0 - p[3]*eta1) / (p[0] + m);
+        return {N*u0, N*u1, N*eta0, N*eta1};
+    }
+
+    // Outgoing photon polarization eps^*(k, lambda), lambda = +-1
+    inline Polarization photonPolarization(Momentum const &k, int lambda)
+    {
+        double const kt  = std::hypot(k[1], k[2]);
+        double const kk  = std::sqrt(kt*kt + k[3]*k[3]);
+        double const cth = k[3] / kk, sth = kt / kk;
+        double const cph = (kt > 0) ? k[1] / kt : 1;
+        double const sph = (kt > 0) ? k[2] / kt : 0;
+        // Two real transverse vectors
+        Momentum const e1 {0, cth*cph, cth*sph, -sth};
+        Momentum const e2 {0, -sph, cph, 0};
+        double const r = 1 / std::sqrt(2.);
+        Polarization eps;
+        for (int mu = 0; mu != 4; ++mu)
+            eps[mu] = std::conj(complex_t(e1[mu], lambda*e2[mu]) * r);
+        return eps;
+    }
+
+    struct MultiPhotonProcess {
+        double                e;
+        double                m;
+        Momentum              p1; // incoming mu^-
+        Momentum              p2; // incoming mu^+
+        std::vector<Momentum> k;  // outgoing photons
+    };
+
+    // Random phase-space point in the center of mass frame (RAMBO for
+    // the massless photons)
+    template<class Generator>
+    MultiPhotonProcess randomProcess(
+            std::size_t n,
+            double      e,
+            double      m,
+            double      sqrtS,
+            Generator  &gen
+            )
+    {
+        std::uniform_real_distribution<double> rand(0, 1);
+        MultiPhotonProcess proc;
+        proc.e = e;
+        proc.m = m;
+        double const E  = sqrtS / 2;
+        double const pz = std::sqrt(E*E - m*m);
+        proc.p1 = {E, 0, 0,  pz};
+        proc.p2 = {E, 0, 0, -pz};
+
+        std::vector<Momentum> q(n);
+        Momentum Q {0, 0, 0, 0};
+        for (auto &qi : q) {
+            double const c   = 2*rand(gen) - 1;
+            double const s   = std::sqrt(1 - c*c);
+            double const phi = 2*M_PI*rand(gen);
+            double const q0  = -std::log(rand(gen) * rand(gen));
+            qi = {q0, q0*s*std::cos(phi), q0*s*std::sin(phi), q0*c};
+            Q = Q + qi;
+        }
+        double const M = std::sqrt(dot(Q, Q));
+        std::array<double, 3> const b {-Q[1]/M, -Q[2]/M, -Q[3]/M};
+        double const gamma = Q[0] / M;
+        double const a = 1 / (1 + gamma);
+        double const x = sqrtS / M;
+        proc.k.resize(n);
+        for (std::size_t i = 0; i != n; ++i) {
+            double const bq = b[0]*q[i][1] + b[1]*q[i][2] + b[2]*q[i][3];
+            proc.k[i][0] = x * (gamma*q[i][0] + bq);
+            for (int j = 0; j != 3; ++j)
+                proc.k[i][j+1] = x * (q[i][j+1] + b[j]*q[i][0] + a*bq*b[j]);
+        }
+        return proc;
+    }
+
+    namespace detail {
+
+        // i*(pslash + m) / (p^2 - m^2) applied to a spinor
+        inline Spinor propagate(Momentum const &p, double m, Spinor const &s)
+        {
+            Spinor res = slash(p) * s;
+            complex_t const factor = complex_t(0, 1) / (dot(p, p) - m*m);
+            for (int a = 0; a != 4; ++a)
+                res[a] = factor * (res[a] + m*s[a]);
+            return res;
+        }
+    }
+
+    // Amplitude i*M for given spins of the muons and polarizations of
+    // the photons, with the Berends-Giele recursion over photon subsets
+    inline complex_t multiPhotonAmplitude(
+            MultiPhotonProcess        const &proc,
+            Spinor                    const &u1,
+            Spinor                    const &v2,
+            std::vector<Polarization> const &eps
+            )
+    {
+        std::size_t const n = proc.k.size();
+        std::size_t const nSubsets = std::size_t(1) << n;
+        // Hand-coded vertex -i*e*Q*epsslash for the muon, Q = -1
+        complex_t const coupling(0, proc.e);
+        std::vector<DiracMatrix> vertex(n);
+        for (std::size_t i = 0; i != n; ++i)
+            vertex[i] = slash(eps[i]);
+
+        std::vector<Spinor>   current(nSubsets);
+        std::vector<Momentum> K(nSubsets, Momentum{0, 0, 0, 0});
+        current[0] = u1;
+        for (std::size_t S = 1; S != nSubsets; ++S) {
+            // Subsets are built in increasing order, S minus its lowest
+            // photon is already known
+            std::size_t const lowest = S & (~S + 1);
+            std::size_t iLowest = 0;
+            while ((std::size_t(1) << iLowest) != lowest)
+                ++iLowest;
+            K[S] = K[S ^ lowest] + proc.k[iLowest];
+            Spinor sum {};
+            for (std::size_t i = 0; i != n; ++i) {
+                std::size_t const bit = std::size_t(1) << i;
+                if (S & bit)
+                    sum = sum + vertex[i] * current[S ^ bit];
+            }
+            for (auto &x : sum)
+                x *= coupling;
+            // The last current is closed with the antimuon spinor
+            // without propagator
+            current[S] = (S == nSubsets - 1) ?
+                sum : detail::propagate(proc.p1 - K[S], proc.m, sum);
+        }
+        return barProduct(v2, current[nSubsets - 1]);
+    }
+
+    // Same amplitude as a sum over the n! Feynman diagrams, used as a
+    // reference for the recursion
+    inline complex_t multiPhotonAmplitudeDiagrams(
+            MultiPhotonProcess        const &proc,
+            Spinor                    const &u1,
+            Spinor                    const &v2,
+            std::vector<Polarization> const &eps
+            )
+    {
+        std::size_t const n = proc.k.size();
+        complex_t const coupling(0, proc.e);
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        complex_t total = 0;
+        do {
+            Spinor s = u1;
+            Momentum p = proc.p1;
+            for (std::size_t j = 0; j != n; ++j) {
+                s = slash(eps[order[j]]) * s;
+                for (auto &x : s)
+                    x *= coupling;
+                p = p - proc.k[order[j]];
+                if (j + 1 != n)
+                    s = detail::propagate(p, proc.m, s);
+            }
+            total += barProduct(v2, s);
+        } while (std::next_permutation(order.begin(), order.end()));
+        return total;
+    }
+}
+
+#endif
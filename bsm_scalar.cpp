@@ -0,0 +1,113 @@
+/*
+ * This program computes the contribution of a new neutral scalar S
+ * to the muon anomalous magnetic moment (g-2).
+ *
+ *  The QED model of main.cpp is extended with a real scalar S of
+ *  mass m_S coupled to the muon through the Yukawa interaction
+ *      L = -y * S * \bar{mu} mu
+ *  Both m_S and y are kept symbolic.
+ *
+ *  The one-loop coefficient of the magnetic operator is computed once
+ *  with the same chromoMagneticOperator() / getWilsonCoefficient()
+ *  extraction as in main.cpp, keeping only the diagrams with the new
+ *  scalar, and is generated in the library bsmlib.
+ *
+ *  The (m_S, y) plane is then scanned by the script
+ *  scan_bsm_scalar.cpp that must be placed in bsmlib/script together
+ *  with execution.h, kinematics.h and scan.h.
+ */
+#include "marty.h"
+#include "execution.h"
+#include "qed_model.h"
+#include "result_store.h"
+
+using namespace std;
+using namespace csl;
+using namespace mty;
+
+int main()
+{
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Model definition
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // Same QED model as in main.cpp, see qed_model.h
+    Model model;
+    Particle muon = demo::buildQedModel(model);
+
+    // New real scalar, neutral under U(1) em
+    Particle scalar = scalarboson_s("S", model);
+    scalar->setSelfConjugate(true);
+    scalar->setMass(constant_s("m_S"));
+    model.addParticle(scalar);
+
+    // Yukawa coupling to the muon, see section 5.3 of the manual
+    // for the definition of custom interaction terms
+    Expr y = constant_s("y");
+    Index al = DiracIndex();
+    Tensor X = MinkowskiVector("X");
+    model.addLagrangianTerm(
+            -y * scalar(X) * GetComplexConjugate(muon({al}, X)) * muon({al}, X)
+            );
+
+    model.refresh();
+    Display(model);
+
+    // A result already generated for the same model and process is 
+    // found in the local store, see result_store.h
+    demo::ResultStore store;
+    string const signature = demo::ResultStore::signature(
+            model, "mu -> mu A", "OneLoop", "forceParticle(S)");
+    if (auto stored = store.find(signature)) {
+        cout << "Result already generated as " << stored->function
+             << " in " << stored->library << endl;
+        return 0;
+    }
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  New physics contribution to (g-2)
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // Only the diagrams with the new scalar are kept, the QED part is
+    // already computed in main.cpp
+    // Diagram filters are presented in section 6.4.3 of the manual
+    FeynOptions options;
+    options.addFilters(filter::forceParticle("S"));
+
+    WilsonSet wilsons = model.computeWilsonCoefficients(
+            OneLoop,
+            {Incoming("mu"), Outgoing("mu"), Outgoing("A")},
+            options
+            );
+    Display(wilsons);
+
+    vector<Wilson> muonMagOp = chromoMagneticOperator(
+            model,
+            wilsons,
+            DiracCoupling::S
+    );
+    Expr scalarMagneticMoment = getWilsonCoefficient(wilsons, muonMagOp);
+    cout << "Scalar contribution to the magnetic operator = "
+         << scalarMagneticMoment << endl;
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Generation of the library
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // The coefficient is symbolic in m_S and y: the library is
+    // generated once and the scan only calls the generated function
+    Library lib("bsmlib");
+    lib.cleanExistingSources();
+    lib.addFunction("mu_magnetic_scalar", scalarMagneticMoment);
+    lib.build(demo::workerCount());
+
+    store.insert(signature, {"mu_magnetic_scalar", "bsmlib"}, scalarMagneticMoment);
+
+    return 0;
+}
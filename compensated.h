@@ -0,0 +1,88 @@
+/*
+ * Compensated summation for the long sums of the generated functions.
+ *
+ * Expanded results (squared amplitudes, expanded (g-2) forms, ...) are
+ * long sums whose terms cancel to a large extent, and the rounding 
+ * errors of a naive sum grow with the size of the cancellation. The 
+ * Neumaier variant of the Kahan summation keeps the rounding error of
+ * each addition (obtained exactly with twoSum()) in a second 
+ * accumulator: the result is as accurate as a sum done in twice the 
+ * precision followed by a rounding to double, for a few more floating
+ * point operations per term.
+ *
+ * The header is standalone, copy it next to the scripts using the
+ * compensated functions of a library (see library_groups.h).
+ */
+#ifndef DEMO_COMPENSATED_H_INCLUDED
+#define DEMO_COMPENSATED_H_INCLUDED
+
+#include <cmath>
+#include <complex>
+
+namespace demo {
+
+    // s + e = a + b exactly, with s = fl(a + b) (Knuth)
+    inline void twoSum(double a, double b, double &s, double &e)
+    {
+        s = a + b;
+        double const bb = s - a;
+        e = (a - (s - bb)) + (b - bb);
+    }
+
+    // Neumaier summation, the compensation is applied at the end
+    class NeumaierSum {
+
+    public:
+
+        void add(double x)
+        {
+            double s, e;
+            twoSum(m_sum, x, s, e);
+            m_sum = s;
+            m_compensation += e;
+        }
+
+        double value() const { return m_sum + m_compensation; }
+
+    private:
+
+        double m_sum          = 0;
+        double m_compensation = 0;
+    };
+
+    // Real and imaginary parts are compensated independently
+    class ComplexNeumaierSum {
+
+    public:
+
+        void add(double x) { m_real.add(x); }
+
+        void add(std::complex<double> const &x)
+        {
+            m_real.add(x.real());
+            m_imag.add(x.imag());
+        }
+
+        std::complex<double> value() const
+        {
+            return {m_real.value(), m_imag.value()};
+        }
+
+    private:
+
+        NeumaierSum m_real;
+        NeumaierSum m_imag;
+    };
+
+    // Compensated sum of [first, last) of complex values
+    template<class Iterator>
+    std::complex<double> compensatedSum(Iterator first, Iterator last)
+    {
+        ComplexNeumaierSum sum;
+        for (; first != last; ++first)
+            sum.add(*first);
+        return sum.value();
+    }
+}
+
+#endif
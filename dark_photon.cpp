@@ -0,0 +1,112 @@
+/*
+ * This program computes the contribution of a dark photon A' to the
+ * muon anomalous magnetic moment (g-2).
+ *
+ *  The U(1) em model of main.cpp is extended with a second U(1) gauge
+ *  group whose boson A' has a mass m_Ap and mixes kinetically with the
+ *  photon through
+ *      L = -eps/2 * F_{mu,nu} F'^{mu,nu}
+ *  After diagonalization of the kinetic terms, at first order in eps,
+ *  A' couples to the electromagnetic current with a strength eps*e. The
+ *  model is built directly in this basis: the muon carries the charge
+ *  -1 under the dark U(1) whose coupling is eps*e.
+ *
+ *  The one-loop coefficient of the magnetic operator is computed with
+ *  eps and m_Ap symbolic, keeping only the diagrams with A', and
+ *  generated in the library darklib.
+ *
+ *  The (eps, m_Ap) plane is then scanned by the script
+ *  scan_dark_photon.cpp that must be placed in darklib/script together
+ *  with execution.h, histogram.h, kinematics.h and scan.h.
+ */
+#include "marty.h"
+#include "execution.h"
+#include "qed_model.h"
+#include "result_store.h"
+
+using namespace std;
+using namespace csl;
+using namespace mty;
+
+int main()
+{
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Model definition
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    Expr e   = constant_s("e");
+    Expr eps = constant_s("eps"); // Kinetic mixing parameter
+
+    // QED model of main.cpp (see qed_model.h) with a second U(1). Both
+    // gauge groups must be defined before model.init(), called by 
+    // initQed()
+    Model model;
+    model.addGaugedGroup(group::Type::U1, "D", eps * e);
+    demo::initQed(model, e);
+    model.renameParticle("A_D", "Ap");
+
+    // Mass term of the dark photon
+    model.getParticle("Ap")->setMass(constant_s("m_Ap"));
+
+    Particle muon = demo::muonParticle(model);
+    muon->setGroupRep("D", -1); // Charge eps*e*(-1) from the mixing
+    model.addParticle(muon);
+
+    model.refresh();
+    Display(model);
+
+    // A result already generated for the same model and process is 
+    // found in the local store, see result_store.h
+    demo::ResultStore store;
+    string const signature = demo::ResultStore::signature(
+            model, "mu -> mu A", "OneLoop", "forceParticle(Ap)");
+    if (auto stored = store.find(signature)) {
+        cout << "Result already generated as " << stored->function
+             << " in " << stored->library << endl;
+        return 0;
+    }
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Dark photon contribution to (g-2)
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // Only the diagrams with the dark photon are kept, the QED part is
+    // already computed in main.cpp
+    FeynOptions options;
+    options.addFilters(filter::forceParticle("Ap"));
+
+    WilsonSet wilsons = model.computeWilsonCoefficients(
+            OneLoop,
+            {Incoming("mu"), Outgoing("mu"), Outgoing("A")},
+            options
+            );
+    Display(wilsons);
+
+    vector<Wilson> muonMagOp = chromoMagneticOperator(
+            model,
+            wilsons,
+            DiracCoupling::S
+    );
+    Expr darkMagneticMoment = getWilsonCoefficient(wilsons, muonMagOp);
+    cout << "Dark photon contribution to the magnetic operator = "
+         << darkMagneticMoment << endl;
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Generation of the library
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    Library lib("darklib");
+    lib.cleanExistingSources();
+    lib.addFunction("mu_magnetic_dark", darkMagneticMoment);
+    lib.build(demo::workerCount());
+
+    store.insert(signature, {"mu_magnetic_dark", "darklib"}, darkMagneticMoment);
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * This program matches a heavy neutral scalar Phi onto the muon dipole
+ * operators.
+ *
+ *  The QED model of main.cpp is extended with a real scalar Phi of mass
+ *  M_Phi coupled to the muon through scalar and pseudoscalar Yukawa
+ *  interactions
+ *      L = -Phi * \bar{mu} (c_S + i*c_P*gamma^5) mu
+ *  The one-loop coefficients of the magnetic (DiracCoupling::S) and 
+ *  electric (DiracCoupling::P) dipole operators are the matching 
+ *  conditions of the low-energy theory. They are computed once with 
+ *  M_Phi, c_S and c_P symbolic, keeping only the diagrams with Phi.
+ *
+ *  The photon vacuum polarization of the model is computed as well, its
+ *  divergence gives the beta function used to run the coefficients 
+ *  down to m_mu (see rg_evolution.h).
+ *
+ *  The coefficients are generated in the library eftlib in the group
+ *  "matching", with a fused kernel returning all the coefficients for a
+ *  batch of UV parameter points (eftlib_matching_batch.h, see 
+ *  library_groups.h). The symbolic matching conditions are recorded in
+ *  the local store (see result_store.h): running the program again for
+ *  the same model with DEMO_REUSE_STORE=1 does not compute them again.
+ *
+ *  The batch of parameter points is evaluated by the script 
+ *  scan_eft_matching.cpp that must be placed in eftlib/script together
+ *  with execution.h, kinematics.h, rg_evolution.h and scan.h.
+ */
+#include "marty.h"
+#include "execution.h"
+#include "library_groups.h"
+#include "qed_model.h"
+#include "result_store.h"
+
+using namespace std;
+using namespace csl;
+using namespace mty;
+
+int main()
+{
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Model definition
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // Same QED model as in main.cpp, see qed_model.h
+    Model model;
+    Particle muon = demo::buildQedModel(model);
+
+    // Heavy real scalar, neutral under U(1) em
+    Particle phi = scalarboson_s("Phi ; \\Phi", model);
+    phi->setSelfConjugate(true);
+    phi->setMass(constant_s("M_Phi"));
+    model.addParticle(phi);
+
+    // Scalar and pseudoscalar couplings to the muon, gamma^5 is 
+    // dirac4.gamma_chir (see section 5.3 of the manual)
+    Expr cS = constant_s("c_S");
+    Expr cP = constant_s("c_P");
+    Index al = DiracIndex();
+    Index be = DiracIndex();
+    Tensor X = MinkowskiVector("X");
+    Expr muBar = GetComplexConjugate(muon({al}, X));
+    model.addLagrangianTerm(-cS * phi(X) * muBar * muon({al}, X));
+    model.addLagrangianTerm(
+            -CSL_I * cP * phi(X) * muBar 
+            * dirac4.gamma_chir({al, be}) * muon({be}, X)
+            );
+
+    model.refresh();
+    Display(model);
+
+    // Matching conditions already computed for the same model are found
+    // in the local store, one entry per dipole operator
+    demo::ResultStore store;
+    string const magneticSignature = demo::ResultStore::signature(
+            model, "mu -> mu A", "OneLoop", "forceParticle(Phi), magnetic");
+    string const electricSignature = demo::ResultStore::signature(
+            model, "mu -> mu A", "OneLoop", "forceParticle(Phi), electric");
+    string const runningSignature = demo::ResultStore::signature(
+            model, "A -> A", "OneLoop");
+    auto storedMagnetic = store.find(magneticSignature);
+    auto storedElectric = store.find(electricSignature);
+    if (storedMagnetic && storedElectric && store.find(runningSignature)) {
+        cout << "Matching conditions already generated as "
+             << storedMagnetic->function << " and " 
+             << storedElectric->function << " in " 
+             << storedMagnetic->library << endl;
+        return 0;
+    }
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Matching onto the dipole operators
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    FeynOptions options;
+    options.addFilters(filter::forceParticle("Phi"));
+
+    // The Wilson coefficients are computed once, both operators are 
+    // extracted from the same set
+    WilsonSet wilsons = model.computeWilsonCoefficients(
+            OneLoop,
+            {Incoming("mu"), Outgoing("mu"), Outgoing("A")},
+            options
+            );
+    Display(wilsons);
+
+    vector<Wilson> magneticOp = chromoMagneticOperator(
+            model,
+            wilsons,
+            DiracCoupling::S
+    );
+    vector<Wilson> electricOp = chromoMagneticOperator(
+            model,
+            wilsons,
+            DiracCoupling::P
+    );
+    Expr magneticMatching = getWilsonCoefficient(wilsons, magneticOp);
+    Expr electricMatching = getWilsonCoefficient(wilsons, electricOp);
+    cout << "Magnetic dipole matching = " << magneticMatching << endl;
+    cout << "Electric dipole matching = " << electricMatching << endl;
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Running in the low-energy theory
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    // The coefficient of g^{mu,nu} in the vacuum polarization, see 
+    // main.cpp. Phi is neutral and does not enter it, the result is the
+    // one of the low-energy theory.
+    Amplitude vacuumPolarization = model.computeAmplitude(
+            OneLoop,
+            {Incoming(OffShell("A")), Outgoing(OffShell("A"))}
+            );
+    WilsonSet wilsonsVacuumPolarization 
+        = model.getWilsonCoefficients(vacuumPolarization);
+    Expr photonGTerm = wilsonsVacuumPolarization[0].coef.getCoefficient();
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Generation of the library
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    Library lib("eftlib");
+    lib.cleanExistingSources();
+    demo::LibraryGroups groups(lib, "eftlib");
+    groups.addFunction("matching", "mu_dipole_magnetic", magneticMatching);
+    groups.addFunction("matching", "mu_dipole_electric", electricMatching);
+    groups.addFunction("running", "photon_self_e_gterm", photonGTerm);
+    lib.build(demo::workerCount());
+    groups.writeHeaders();
+    groups.writeBatchKernel("matching");
+
+    store.insert(magneticSignature, {"mu_dipole_magnetic", "eftlib"}, magneticMatching);
+    store.insert(electricSignature, {"mu_dipole_electric", "eftlib"}, electricMatching);
+    store.insert(runningSignature, {"photon_self_e_gterm", "eftlib"}, photonGTerm);
+
+    return 0;
+}
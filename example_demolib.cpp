@@ -1,9 +1,14 @@
-#include "demolib.h"
+#include "demolib_magnetic.h"
+#include "demolib_self_energy.h"
+#include "kinematics.h"
 
 // Include looptools to call setlambda()
 // in order to get divergent contributions
 #include "clooptools.h"
 
+#include <cmath>
+#include <iostream>
+
 using namespace demolib;
 
 int main() {
@@ -24,8 +29,9 @@ int main() {
     /////////////////////////////////////////
     /////////////////////////////////////////
 
-    // s_11 required by the function but irrelevant
-    params.s_11 = 0; // = p*p, irrelevant when taking divergent part
+    // s_11 = p*p required by the function but irrelevant when taking
+    // the divergent part
+    demo::setTwoPointKinematics(params, 0);
 
     // Consider the divergent contributions
     setlambda(-1);     // Tell looptools to get coef of 1/eps
@@ -81,8 +87,8 @@ int main() {
     std::cout << "######################################\n";
     std::cout << "####  MUON ANOMALOUS MAGNETIC MOMENT\n";
     std::cout << "######################################\n\n";
-    // Kinematical variable s_12 for mu -> mu gamma
-    params.s_12 = m*m;
+    // Kinematical variable s_12 for mu -> mu gamma, on-shell photon
+    demo::setVertexKinematics(params, m);
     // Do not forget to set finite contributions for (g-2) !
     params.Finite = 1;
     setlambda(0);
@@ -95,6 +101,15 @@ int main() {
     std::cout << "(g-2)µ  [evaluated]  = " << -8*m/params.e * C_mag_eval << std::endl;
     std::cout << "(g-2)µ  [simplified] = " << -8*m/params.e * C_mag_simpli << std::endl;
     std::cout << "Theoretical result   = " << alpha/M_PI << " ( = alpha/pi)" << std::endl;
+
+    // MARTY computes amplitudes up to one loop, the two-loop QED term
+    // (Petermann, Sommerfield 1957) is only given here to show the size
+    // of the next correction: (g-2)µ = alpha/pi + 2*C2*(alpha/pi)^2
+    double const zeta3 = 1.2020569031595942;
+    double const C2 = 197./144 + M_PI*M_PI/12 
+        - M_PI*M_PI/2 * std::log(2.) + 3./4 * zeta3;
+    std::cout << "Two-loop QED term    = " << 2*C2*std::pow(alpha/M_PI, 2) 
+              << " ( = 2*C2*(alpha/pi)^2, C2 = " << C2 << ")" << std::endl;
     
     return 0;
 }
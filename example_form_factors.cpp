@@ -0,0 +1,109 @@
+#include "demolib_form_factors.h"
+#include "execution.h"
+#include "kinematics.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+using namespace demolib;
+
+// Analytic one-loop Pauli form factor, Peskin & Schroeder eq. 6.58
+// integrated over two Feynman parameters, valid below the threshold
+// q^2 < 4m^2
+double F2Analytic(double alpha, double m, double q2)
+{
+    return alpha/(2*M_PI) * demo::simpson([&](double u) {
+        return m*m / (m*m - q2*u*(1 - u));
+    }, 0, 1);
+}
+
+int main(int argc, char const *argv[]) {
+
+    // Number of q^2 points, can be given on the command line
+    std::size_t const nQ2 = demo::gridSizeArgument(argc, argv, 1, 1000);
+    if (nQ2 < 2) {
+        // The grid includes both ends of [q2Min, q2Max]
+        std::cerr << "usage: " << argv[0] << " [nQ2]"
+                  << " (at least 2 points)\n";
+        return 1;
+    }
+    double const q2Min = -1, q2Max = 0.03; // in GeV^2, below 4m^2
+
+    param_t params;
+
+    double alpha = 1./137;
+    double m = 0.1;
+    params.e = std::sqrt(4*M_PI*alpha);
+    params.m_mu = m;
+    params.Finite = 1;
+    setlambda(0);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Form factors at general q^2
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // Conventions (see example_demolib.cpp): MARTY multiplies the 
+    // amplitude by i, the tree-level vector coefficient is then -e and
+    // the magnetic coefficient C gives F2 = -4m/e * C. F1 is normalized
+    // with its one-loop value at q^2 = 0 so that F1(0) = 1.
+    //
+    // F2 is finite. F1(q^2) - F1(0) is not: the soft photon exchanged
+    // between the two muon lines gives an infrared divergence that only
+    // cancels against real emission. With setlambda(0) LoopTools keeps
+    // the finite part of the dimensionally regularized integrals, F1 is
+    // therefore only defined up to this choice and depends on the scale
+    // set with setmudim(). Both are printed along with F1.
+    param_t zero = params;
+    demo::setVertexKinematics(zero, m, 0);
+    double const vector0 = mu_vertex_vector_q2(zero).real();
+
+    // All the points share the same muon mass: the integrals that do 
+    // not depend on q^2 are computed once and then found in the cache of
+    // LoopTools for all the points of a worker, and F1 and F2 at the 
+    // same q^2 share their integrals as they are evaluated together.
+    // The cache is only cleared once the scan is done.
+    demo::SharedArray<double> F1(nQ2);
+    demo::SharedArray<double> F2(nQ2);
+    demo::processFor(nQ2, [&](std::size_t begin, std::size_t end, unsigned) {
+        param_t local = params;
+        for (std::size_t i = begin; i != end; ++i) {
+            double const q2 = q2Min + (q2Max - q2Min) * i / (nQ2 - 1);
+            demo::setVertexKinematics(local, m, q2);
+            F1[i] = 1 - (mu_vertex_vector_q2(local).real() - vector0) / params.e;
+            F2[i] = -4*m/params.e * mu_vertex_magnetic_q2(local).real();
+        }
+    });
+    clearcache();
+
+    std::cout << "######################################\n";
+    std::cout << "####  MUON FORM FACTORS\n";
+    std::cout << "######################################\n\n";
+    std::cout << "F1 is IR divergent, values for the LoopTools regulator"
+              << " lambda = " << getlambda() << ", mu^2 = " << getmudim()
+              << " (F2 does not depend on it)\n\n";
+    for (std::size_t i : {std::size_t(0), nQ2 / 2, nQ2 - 1}) {
+        double const q2 = q2Min + (q2Max - q2Min) * i / (nQ2 - 1);
+        std::cout << "q^2 = " << q2 << ":\n";
+        std::cout << "  F1 = " << F1[i] << std::endl;
+        std::cout << "  F2 = " << F2[i] << std::endl;
+        std::cout << "  (should be equal to " << F2Analytic(alpha, m, q2) 
+                  << ")\n";
+    }
+
+    std::ofstream out("form_factors.dat");
+    out << "# F1: IR finite part for LoopTools lambda = " << getlambda()
+        << ", mu^2 = " << getmudim() << "\n";
+    out << "# q2  F1  F2\n";
+    for (std::size_t i = 0; i != nQ2; ++i)
+        out << q2Min + (q2Max - q2Min) * i / (nQ2 - 1) << ' '
+            << F1[i] << ' ' << F2[i] << '\n';
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "gaugelib.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <iostream>
+
+using namespace gaugelib;
+
+int main(int argc, char const *argv[]) {
+
+    // Number of parameter points, can be given on the command line
+    std::size_t const nPoints = demo::gridSizeArgument(argc, argv, 1, 10000);
+    if (nPoints == 0) {
+        std::cerr << "usage: " << argv[0] << " [nPoints]"
+                  << " (the number of points must be positive)\n";
+        return 1;
+    }
+
+    param_t params;
+    demo::setOnShellVertex(params);
+    setlambda(0);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Gauge independence of (g-2)
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // The muon mass is varied over the batch, the photon is on-shell.
+    // Points are evaluated on forked workers as the 
+    // generated functions call LoopTools.
+    demo::SharedArray<double> relDiff(nPoints);
+    demo::processForBatches(nPoints, 1024, [&](std::size_t begin, std::size_t end) {
+        param_t local = params;
+        for (std::size_t i = begin; i != end; ++i) {
+            double const m = 1e-3 * std::pow(1e6, double(i) / nPoints);
+            demo::setOnShellVertex(local, demo::alphaQed, m);
+            double const feynman = mu_magnetic_feynman(local).real();
+            double const landau  = mu_magnetic_landau(local).real();
+            // Relative to the larger of both, two vanishing results agree
+            double const scale = std::max(std::abs(feynman), std::abs(landau));
+            relDiff[i] = (scale > 0) ? std::abs(feynman - landau) / scale : 0;
+        }
+    }, clearcache);
+
+    double maxDiff = 0;
+    for (double diff : relDiff)
+        maxDiff = std::max(maxDiff, diff);
+
+    std::cout << "######################################\n";
+    std::cout << "####  GAUGE INDEPENDENCE OF (g-2)\n";
+    std::cout << "######################################\n\n";
+    std::cout << "Largest relative difference Feynman / Landau over "
+              << nPoints << " points = " << maxDiff << std::endl;
+    std::cout << "(should be compatible with 0)\n";
+
+    return 0;
+}
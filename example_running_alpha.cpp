@@ -0,0 +1,68 @@
+#include "demolib_vacuum_polarization.h"
+#include "kinematics.h"
+#include "running_alpha.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace demolib;
+
+// Analytic one-loop Pihat(-Q^2) from a lepton of mass m, Peskin &
+// Schroeder eq. 7.90 continued to space-like momenta
+double piHatAnalytic(double alpha, double m, double Q2)
+{
+    return 2*alpha/M_PI * demo::simpson([&](double x) {
+        return x*(1 - x) * std::log(1 + x*(1 - x)*Q2/(m*m));
+    }, 0, 1);
+}
+
+int main() {
+
+    param_t params;
+
+    double const alpha = demo::alphaQed;
+    double const m     = demo::muonMass;
+    // The vertex invariant s_12 is unused here, the momentum of the
+    // photon is set by setTwoPointKinematics() below
+    demo::setOnShellVertex(params, alpha, m);
+    setlambda(0);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Vacuum polarization from the muon loop
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // photon_self_e_gterm is the coefficient of g^{mu,nu}, equal to
+    // -q^2*Pi(q^2) in MARTY's conventions (the amplitude is multiplied
+    // by i when extracting coefficients, see example_demolib.cpp).
+    // Pi(0) is taken at a small q^2 compared to m^2.
+    auto pi = [&](double q2) {
+        param_t local = params;
+        demo::setTwoPointKinematics(local, q2);
+        return -photon_self_e_gterm(local).real() / q2;
+    };
+    double const pi0 = pi(-1e-4*m*m);
+    auto piHat = [&](double Q2) { return pi(-Q2) - pi0; };
+
+    std::cout << "######################################\n";
+    std::cout << "####  RUNNING COUPLING\n";
+    std::cout << "######################################\n\n";
+
+    // The loop is evaluated once per point of the table, the lookups
+    // are then only interpolations
+    demo::RunningAlphaTable alphaTable(alpha, 1e-4, 1e6, 1000, piHat);
+
+    for (double Q2 : {1e-2, 1., 1e2, 1e4}) {
+        std::cout << "1/alpha(Q^2 = " << Q2 << ") = " 
+                  << 1 / alphaTable(Q2) << std::endl;
+        std::cout << "(should be equal to "
+                  << (1 - piHatAnalytic(alpha, m, Q2)) / alpha << ")\n";
+    }
+
+    return 0;
+}
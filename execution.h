@@ -0,0 +1,368 @@
+/*
+ * Process-wide execution context shared by the MARTY programs of this
+ * demo and by the numerical scripts running in the generated libraries.
+ *
+ * All the parallel parts (compilation of the generated library,
+ * parameter scans, ...) ask this context how many workers they may use
+ * so that they never run more workers than requested on the machine.
+ *
+ * Configuration:
+ *  - DEMO_NUM_THREADS=n   : number of workers (default: number of
+ *                           hardware threads), or setWorkerCount(n)
+ *  - DEMO_CPU_AFFINITY=1  : pin each worker to one of the CPUs the
+ *                           process is allowed to run on, or
+ *                           setCpuAffinity(true)
+ *
+ * The header is self-contained, to use it in a script of a generated
+ * library just copy it next to the script (in demolib/script for
+ * example).
+ */
+#ifndef DEMO_EXECUTION_H_INCLUDED
+#define DEMO_EXECUTION_H_INCLUDED
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace demo {
+
+    namespace detail {
+
+        struct ExecutionContext {
+            unsigned         workers;
+            bool             affinity;
+            std::vector<int> cpus; // CPUs available to the process
+        };
+
+        inline unsigned defaultWorkerCount()
+        {
+            if (char const *env = std::getenv("DEMO_NUM_THREADS")) {
+                int const n = std::atoi(env);
+                if (n > 0)
+                    return static_cast<unsigned>(n);
+            }
+            unsigned const n = std::thread::hardware_concurrency();
+            return (n == 0) ? 1 : n;
+        }
+
+        inline bool defaultAffinity()
+        {
+            char const *env = std::getenv("DEMO_CPU_AFFINITY");
+            return env && std::atoi(env) != 0;
+        }
+
+        inline std::vector<int> availableCpus()
+        {
+            std::vector<int> cpus;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                for (int i = 0; i != CPU_SETSIZE; ++i)
+                    if (CPU_ISSET(i, &set))
+                        cpus.push_back(i);
+            }
+            return cpus;
+        }
+
+        // Resident memory of the calling process in kB
+        inline long residentMemory()
+        {
+            long size = 0, resident = 0;
+            if (std::FILE *statm = std::fopen("/proc/self/statm", "r")) {
+                if (std::fscanf(statm, "%ld %ld", &size, &resident) != 2)
+                    resident = 0;
+                std::fclose(statm);
+            }
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+
+        // Waits for a child process, retrying when interrupted by a 
+        // signal. Returns true if the child exited with status 0.
+        inline bool waitChild(pid_t pid)
+        {
+            int status;
+            while (waitpid(pid, &status, 0) < 0)
+                if (errno != EINTR)
+                    return false;
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+
+        // Kills and reaps child processes whose work is abandoned
+        inline void killChildren(std::vector<pid_t> const &children)
+        {
+            for (pid_t pid : children)
+                kill(pid, SIGKILL);
+            for (pid_t pid : children)
+                waitChild(pid);
+        }
+
+        inline ExecutionContext &context()
+        {
+            static ExecutionContext ctx {
+                defaultWorkerCount(),
+                defaultAffinity(),
+                availableCpus()
+            };
+            return ctx;
+        }
+    }
+
+    // Number of workers any parallel part of the program may use
+    inline unsigned workerCount()
+    {
+        return detail::context().workers;
+    }
+
+    // Sets the number of workers, 0 restores the default value
+    inline void setWorkerCount(unsigned n)
+    {
+        detail::context().workers = (n == 0) ? detail::defaultWorkerCount() : n;
+    }
+
+    inline bool cpuAffinity()
+    {
+        return detail::context().affinity;
+    }
+
+    inline void setCpuAffinity(bool affinity)
+    {
+        detail::context().affinity = affinity;
+    }
+
+    // Pins the calling thread to the CPU attributed to the worker, does
+    // nothing if the CPU affinity is disabled
+    inline void pinCurrentThread(unsigned worker)
+    {
+        auto const &ctx = detail::context();
+        if (!ctx.affinity || ctx.cpus.empty())
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(ctx.cpus[worker % ctx.cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    // Calls f(begin, end, worker) on contiguous chunks of [0, n), one
+    // chunk per worker. The calling thread takes the first chunk and
+    // the function returns once all the chunks are done. If f() throws
+    // in any worker, all the threads are joined first and the exception
+    // of the first worker that failed is rethrown.
+    template<class Func>
+    void parallelFor(std::size_t n, Func &&f)
+    {
+        if (n == 0)
+            return;
+        std::size_t const nWorkers = std::min<std::size_t>(workerCount(), n);
+        std::size_t const chunk    = (n + nWorkers - 1) / nWorkers;
+        std::vector<std::exception_ptr> errors(nWorkers);
+        std::vector<std::thread> threads;
+        threads.reserve(nWorkers - 1);
+        auto run = [&f, &errors](
+                std::size_t begin, std::size_t end, std::size_t w) {
+            try {
+                pinCurrentThread(static_cast<unsigned>(w));
+                f(begin, end, static_cast<unsigned>(w));
+            }
+            catch (...) {
+                errors[w] = std::current_exception();
+            }
+        };
+        try {
+            for (std::size_t w = 1; w < nWorkers; ++w) {
+                std::size_t const begin = w * chunk;
+                std::size_t const end   = std::min(n, begin + chunk);
+                if (begin >= end)
+                    break;
+                threads.emplace_back(run, begin, end, w);
+            }
+        }
+        catch (...) {
+            // A thread could not be started, the others are joined 
+            // before leaving
+            for (auto &thread : threads)
+                thread.join();
+            throw;
+        }
+        run(std::size_t(0), std::min(n, chunk), 0);
+        for (auto &thread : threads)
+            thread.join();
+        for (auto const &error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+
+    // Array of trivially copyable values in memory shared between the
+    // process and its forked children, see processFor()
+    template<class T>
+    class SharedArray {
+
+        static_assert(std::is_trivially_copyable<T>::value,
+                "SharedArray only holds trivially copyable types");
+
+    public:
+
+        explicit SharedArray(std::size_t t_size)
+            :m_size(t_size)
+        {
+            if (m_size == 0)
+                return;
+            void *mem = mmap(nullptr, m_size * sizeof(T),
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                    -1, 0);
+            if (mem == MAP_FAILED)
+                throw std::runtime_error("SharedArray: mmap failed");
+            m_data = static_cast<T*>(mem);
+            std::fill(m_data, m_data + m_size, T{});
+        }
+
+        SharedArray(SharedArray const &) = delete;
+        SharedArray &operator=(SharedArray const &) = delete;
+
+        SharedArray(SharedArray &&other) noexcept
+            :m_data(other.m_data),
+            m_size(other.m_size)
+        {
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+
+        ~SharedArray()
+        {
+            if (m_data)
+                munmap(m_data, m_size * sizeof(T));
+        }
+
+        std::size_t size() const { return m_size; }
+        T       *data()       { return m_data; }
+        T const *data() const { return m_data; }
+        T       &operator[](std::size_t i)       { return m_data[i]; }
+        T const &operator[](std::size_t i) const { return m_data[i]; }
+        T       *begin()       { return m_data; }
+        T       *end()         { return m_data + m_size; }
+        T const *begin() const { return m_data; }
+        T const *end()   const { return m_data + m_size; }
+
+    private:
+
+        T          *m_data = nullptr;
+        std::size_t m_size;
+    };
+
+    // Same as parallelFor() but each worker except the first one runs in
+    // a forked process. This is the version to use for code that is not
+    // thread-safe, typically generated functions calling LoopTools whose
+    // cache of integrals is global. Results must be written in a
+    // SharedArray created before the call, other writes are lost when
+    // the child processes exit. No child outlives the call: if a fork 
+    // fails or f() throws in the calling process, the children already
+    // started are killed and reaped before the error is thrown.
+    template<class Func>
+    void processFor(std::size_t n, Func &&f)
+    {
+        if (n == 0)
+            return;
+        std::size_t const nWorkers = std::min<std::size_t>(workerCount(), n);
+        std::size_t const chunk    = (n + nWorkers - 1) / nWorkers;
+        std::cout.flush();
+        std::vector<pid_t> children;
+        children.reserve(nWorkers - 1);
+        for (std::size_t w = 1; w < nWorkers; ++w) {
+            std::size_t const begin = w * chunk;
+            std::size_t const end   = std::min(n, begin + chunk);
+            if (begin >= end)
+                break;
+            pid_t const pid = fork();
+            if (pid < 0) {
+                detail::killChildren(children);
+                throw std::runtime_error("processFor: fork failed");
+            }
+            if (pid == 0) {
+                // An exception must not unwind past fork(): the child
+                // would go on running the caller's code
+                try {
+                    pinCurrentThread(static_cast<unsigned>(w));
+                    f(begin, end, static_cast<unsigned>(w));
+                }
+                catch (...) {
+                    std::cout.flush();
+                    _exit(1);
+                }
+                std::cout.flush();
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        try {
+            pinCurrentThread(0);
+            f(std::size_t(0), std::min(n, chunk), 0u);
+        }
+        catch (...) {
+            detail::killChildren(children);
+            throw;
+        }
+        bool failed = false;
+        for (pid_t pid : children)
+            failed = !detail::waitChild(pid) || failed;
+        if (failed)
+            throw std::runtime_error("processFor: a worker process failed");
+    }
+
+    // Calls f() in a forked process and waits for it. Everything f()
+    // allocates is released when the process exits, including what
+    // MARTY keeps for the whole lifetime of a program such as the 
+    // abbreviations created by computeAmplitude() and the Wilson 
+    // coefficient extraction. Drivers running many independent 
+    // calculations use it to keep their memory bounded. As for 
+    // processFor(), results must be written in a SharedArray created 
+    // before the call. 
+    //
+    // Returns the growth of the resident memory of the forked process 
+    // during f() in kB: its peak resident memory minus the memory it 
+    // had when f() started. The resident pages the child inherits from
+    // the parent are counted from the start, they are therefore not 
+    // part of the result, even when f() writes to them and gets its own
+    // copy.
+    template<class Func>
+    long runIsolated(Func &&f)
+    {
+        SharedArray<long> growth(1);
+        std::cout.flush();
+        pid_t const pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("runIsolated: fork failed");
+        if (pid == 0) {
+            try {
+                long const baseline = detail::residentMemory();
+                f();
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                growth[0] = usage.ru_maxrss - baseline;
+            }
+            catch (...) {
+                std::cout.flush();
+                _exit(1);
+            }
+            std::cout.flush();
+            _exit(0);
+        }
+        if (!detail::waitChild(pid))
+            throw std::runtime_error("runIsolated: the process failed");
+        return growth[0];
+    }
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Index of the Feynman rules of a model by field content.
+ *
+ * model.getFeynmanRules() is a flat list of vertices, finding the 
+ * vertices of a given set of fields means comparing the fields of every
+ * rule. FeynmanRuleIndex sorts the fields of each vertex once (the name
+ * of the field, followed by ^* for a conjugated field) and stores the 
+ * rules under the joined names: the vertices of a field content are 
+ * then found with one hash lookup, whatever the size of the model.
+ *
+ * The index stores pointers to the rules of the model, the vertex 
+ * expressions are shared and never copied. It is valid as long as the 
+ * rules of the model are not recomputed (model.refresh()).
+ */
+#ifndef DEMO_FEYNMAN_RULE_INDEX_H_INCLUDED
+#define DEMO_FEYNMAN_RULE_INDEX_H_INCLUDED
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "marty.h"
+
+namespace demo {
+
+    class FeynmanRuleIndex {
+
+    public:
+
+        using Rules = std::vector<mty::FeynmanRule const*>;
+
+        explicit FeynmanRuleIndex(std::vector<mty::FeynmanRule> const &rules)
+        {
+            m_index.reserve(rules.size());
+            for (auto const &rule : rules) {
+                std::vector<std::string> fields;
+                for (auto const &field : rule.getFieldProduct())
+                    fields.push_back(field.isComplexConjugate() ?
+                            field.getName() + "^*" : field.getName());
+                m_index[key(std::move(fields))].push_back(&rule);
+            }
+        }
+
+        // Number of distinct field contents
+        std::size_t size() const { return m_index.size(); }
+
+        // Vertices with exactly these fields, in any order, for example
+        // find({"mu", "mu^*", "A"})
+        Rules const &find(std::vector<std::string> fields) const
+        {
+            static Rules const none;
+            auto pos = m_index.find(key(std::move(fields)));
+            return (pos == m_index.end()) ? none : pos->second;
+        }
+
+        static std::string key(std::vector<std::string> fields)
+        {
+            std::sort(fields.begin(), fields.end());
+            std::string res;
+            for (auto const &field : fields) {
+                res += field;
+                res += ';';
+            }
+            return res;
+        }
+
+    private:
+
+        std::unordered_map<std::string, Rules> m_index;
+    };
+}
+
+#endif
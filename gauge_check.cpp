@@ -0,0 +1,104 @@
+/*
+ * This program checks the gauge independence of the muon magnetic 
+ * moment computed in main.cpp.
+ *
+ *  main.cpp fixes the photon in the Feynman gauge (xi = 1) where the
+ *  intermediate expressions are the smallest. Here the coefficient of 
+ *  the magnetic operator is computed both in the Feynman gauge and in 
+ *  the Landau gauge (xi = 0), each on its own model with the gauge 
+ *  fixed before model.refresh(), and both results are generated in the
+ *  library gaugelib.
+ *
+ *  Two gauges are enough at one loop: the vertex has a single photon
+ *  propagator
+ *      -i/k^2 * (g^{mu,nu} - (1 - xi)*k^mu*k^nu/k^2)
+ *  so the coefficient is linear in xi, C(xi) = xi*C(1) + (1 - xi)*C(0).
+ *  It does not depend on xi if and only if C(1) = C(0), which is what
+ *  is checked instead of generating a function of a symbolic xi.
+ *
+ *  The vector current coefficient of the vertex depends on the gauge,
+ *  the program checks that it differs between both models before 
+ *  comparing the magnetic coefficients, so that the comparison cannot
+ *  pass because both models were in the same gauge.
+ *
+ *  The script example_gauge_check.cpp (to be placed in gaugelib/script
+ *  together with execution.h and kinematics.h) evaluates both 
+ *  functions on a batch of parameter points in parallel and reports the
+ *  largest relative difference.
+ */
+#include "marty.h"
+#include "execution.h"
+#include "qed_model.h"
+
+using namespace std;
+using namespace csl;
+using namespace mty;
+
+// Coefficients of the muon-photon vertex, see main.cpp
+struct VertexResults {
+    Expr vector;   // Coefficient of the gamma^mu current
+    Expr magnetic; // Coefficient of the magnetic operator
+};
+
+VertexResults computeVertex(Model &model)
+{
+    WilsonSet wilsons = model.computeWilsonCoefficients(
+            OneLoop,
+            {Incoming("mu"), Outgoing("mu"), Outgoing("A")}
+            );
+    vector<Wilson> muonMagOp = chromoMagneticOperator(
+            model, 
+            wilsons, 
+            DiracCoupling::S
+    );
+    VertexResults results;
+    results.vector   = wilsons[0].coef.getCoefficient();
+    results.magnetic = getWilsonCoefficient(wilsons, muonMagOp);
+    return results;
+}
+
+int main()
+{
+    // Same QED model as in main.cpp (see qed_model.h), built once per 
+    // gauge. The gauge is part of the Feynman rules derived by 
+    // refresh(), it is therefore fixed before.
+    Model feynmanModel;
+    demo::buildQedModel(feynmanModel, gauge::Type::Feynman);
+    feynmanModel.refresh();
+
+    Model landauModel;
+    demo::buildQedModel(landauModel, gauge::Type::Landau);
+    landauModel.refresh();
+
+    // Production gauge
+    VertexResults feynman = computeVertex(feynmanModel);
+    cout << "Feynman gauge: " 
+         << Evaluated(feynman.magnetic, eval::abbreviation) << endl;
+
+    // Verification gauge
+    VertexResults landau = computeVertex(landauModel);
+    cout << "Landau gauge : " 
+         << Evaluated(landau.magnetic, eval::abbreviation) << endl;
+
+    // The vector coefficient is gauge dependent (its divergence is 
+    // proportional to xi): equal coefficients mean that both 
+    // calculations were done in the same gauge
+    Expr vectorDiff = DeepExpanded(Evaluated(
+                feynman.vector - landau.vector, 
+                eval::abbreviation
+                ));
+    cout << "Vector coefficient, Feynman - Landau: " << vectorDiff << endl;
+    if (vectorDiff == CSL_0) {
+        cerr << "The vertex is the same in both gauges, the gauge choice"
+             << " was not applied\n";
+        return 1;
+    }
+
+    Library lib("gaugelib");
+    lib.cleanExistingSources();
+    lib.addFunction("mu_magnetic_feynman", feynman.magnetic);
+    lib.addFunction("mu_magnetic_landau", landau.magnetic);
+    lib.build(demo::workerCount());
+
+    return 0;
+}
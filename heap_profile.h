@@ -0,0 +1,350 @@
+/*
+ * Heap profile of the symbolic stages of the MARTY programs.
+ *
+ * Two complementary measures, enabled at run time with 
+ * DEMO_HEAP_PROFILE=1:
+ *  - nodeCensus() walks an expression and counts its nodes by type 
+ *    (sums, products, constants, tensor elements, functions, ...). 
+ *    Subtrees shared between several parents are stored once in memory,
+ *    the census gives both the unique nodes and the size of the 
+ *    expanded tree.
+ *  - The allocation tracker attributes every heap allocation of the 
+ *    program (MARTY and CSL included) to the stage that created it (see
+ *    ProfileStage in profiler.h), with live and peak bytes and counts.
+ *    It replaces the global operator new and delete, aligned forms 
+ *    included, and is compiled only in a program defining 
+ *    DEMO_TRACK_ALLOCATIONS before including this header (make main 
+ *    CXXFLAGS=-DDEMO_TRACK_ALLOCATIONS). Each allocation then costs a 
+ *    16-byte header (one alignment unit for over-aligned types) and a
+ *    few atomic updates.
+ * Both can be printed at any point of the program.
+ */
+#ifndef DEMO_HEAP_PROFILE_H_INCLUDED
+#define DEMO_HEAP_PROFILE_H_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "marty.h"
+#include "profiler.h"
+
+namespace demo {
+
+    inline bool heapProfileEnabled()
+    {
+        static bool const enabled = []() {
+            char const *env = std::getenv("DEMO_HEAP_PROFILE");
+            return env && std::atoi(env) != 0;
+        }();
+        return enabled;
+    }
+
+    /////////////////////////////////////////////
+    //  Census of expression nodes
+    /////////////////////////////////////////////
+
+    // Counts of nodes indexed by csl::Type. CSL has fewer types than
+    // slots, a type beyond them would be counted in the last slot.
+    constexpr std::size_t nodeTypeSlots = 64;
+    using NodeCounts = std::array<std::size_t, nodeTypeSlots>;
+
+    struct NodeCensus {
+        NodeCounts  unique {}; // Nodes in memory
+        NodeCounts  tree   {}; // Nodes of the tree
+        std::size_t nUnique = 0;
+        std::size_t nTree   = 0;
+    };
+
+    inline std::size_t nodeTypeSlot(csl::Type type)
+    {
+        std::size_t const slot = static_cast<std::size_t>(type);
+        return (slot < nodeTypeSlots) ? slot : nodeTypeSlots - 1;
+    }
+
+    inline NodeCensus nodeCensus(csl::Expr const &expr)
+    {
+        NodeCensus census;
+        // First walk: unique nodes in post-order (children before their
+        // parents) and number of references to each of them
+        std::unordered_map<csl::Abstract const*, std::size_t> references;
+        std::vector<csl::Abstract const*> order;
+        std::vector<std::pair<csl::Abstract const*, bool>> stack {
+            {expr.get(), false}
+        };
+        references[expr.get()] = 1;
+        while (!stack.empty()) {
+            auto [node, expanded] = stack.back();
+            stack.pop_back();
+            if (expanded) {
+                order.push_back(node);
+                continue;
+            }
+            stack.push_back({node, true});
+            for (std::size_t i = 0; i != node->size(); ++i) {
+                csl::Abstract const *arg = node->getArgument(i).get();
+                if (references[arg]++ == 0)
+                    stack.push_back({arg, false});
+            }
+        }
+        // Second walk: tree size of each unique node from the sizes of
+        // its children, so that shared subtrees are walked only once. 
+        // The entry of a child is freed once all its parents are counted.
+        std::unordered_map<csl::Abstract const*, NodeCounts> sizes;
+        for (csl::Abstract const *node : order) {
+            std::size_t const slot = nodeTypeSlot(node->getType());
+            ++census.unique[slot];
+            ++census.nUnique;
+            NodeCounts size {};
+            ++size[slot];
+            for (std::size_t i = 0; i != node->size(); ++i) {
+                csl::Abstract const *arg = node->getArgument(i).get();
+                auto pos = sizes.find(arg);
+                for (std::size_t t = 0; t != nodeTypeSlots; ++t)
+                    size[t] += pos->second[t];
+                if (--references[arg] == 0)
+                    sizes.erase(pos);
+            }
+            sizes.emplace(node, size);
+        }
+        census.tree = sizes.at(expr.get());
+        for (std::size_t n : census.tree)
+            census.nTree += n;
+        return census;
+    }
+
+    inline void printNodeCensus(
+            std::ostream      &out,
+            std::string const &name,
+            csl::Expr   const &expr
+            )
+    {
+        NodeCensus const census = nodeCensus(expr);
+        out << "[heap] " << name << ": " << census.nUnique 
+            << " nodes in memory, " << census.nTree << " in the tree\n";
+        for (std::size_t t = 0; t != nodeTypeSlots; ++t) {
+            if (census.unique[t] == 0)
+                continue;
+            std::ostringstream type;
+            type << static_cast<csl::Type>(t);
+            out << "[heap]     " << std::setw(20) << std::left << type.str() 
+                << std::right << std::setw(10) << census.unique[t] 
+                << std::setw(12) << census.tree[t] << '\n';
+        }
+    }
+
+    /////////////////////////////////////////////
+    //  Allocations by stage
+    /////////////////////////////////////////////
+
+    namespace detail {
+
+        struct AllocationStats {
+            std::atomic<char const*>  stage;
+            std::atomic<std::int64_t> allocations;
+            std::atomic<std::int64_t> liveBytes;
+            std::atomic<std::int64_t> peakBytes;
+            std::atomic<std::int64_t> liveCount;
+            std::atomic<std::int64_t> peakCount;
+        };
+
+        constexpr std::size_t maxAllocationStages = 64;
+        // Zero-initialized before any dynamic initialization, usable by
+        // the allocations of static constructors
+        inline AllocationStats allocationStats[maxAllocationStages];
+        inline std::atomic<bool> allocationTracking {false};
+
+        inline void updatePeak(std::atomic<std::int64_t> &peak, std::int64_t value)
+        {
+            std::int64_t current = peak.load(std::memory_order_relaxed);
+            while (value > current 
+                    && !peak.compare_exchange_weak(current, value))
+                ;
+        }
+
+        // Slot of the current stage, the last slot collects the stages
+        // beyond the size of the table
+        inline std::size_t allocationSlot()
+        {
+            char const *stage = profilerState().stage.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i != maxAllocationStages - 1; ++i) {
+                char const *slot = allocationStats[i].stage.load();
+                if (slot == stage)
+                    return i;
+                if (!slot) {
+                    char const *expected = nullptr;
+                    if (allocationStats[i].stage.compare_exchange_strong(expected, stage)
+                            || expected == stage)
+                        return i;
+                }
+            }
+            return maxAllocationStages - 1;
+        }
+
+        inline void recordAllocation(std::size_t slot, std::int64_t size)
+        {
+            AllocationStats &stats = allocationStats[slot];
+            stats.allocations.fetch_add(1, std::memory_order_relaxed);
+            updatePeak(stats.peakBytes, stats.liveBytes.fetch_add(size) + size);
+            updatePeak(stats.peakCount, stats.liveCount.fetch_add(1) + 1);
+        }
+
+        inline void recordDeallocation(std::size_t slot, std::int64_t size)
+        {
+            AllocationStats &stats = allocationStats[slot];
+            stats.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+            stats.liveCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Live and peak allocations of each stage, by creating stage
+    inline void printAllocations(std::ostream &out)
+    {
+        if (!detail::allocationTracking) {
+            out << "[heap] allocation tracking disabled (build with "
+                << "-DDEMO_TRACK_ALLOCATIONS)\n";
+            return;
+        }
+        out << "[heap] " << std::setw(20) << std::left << "stage" 
+            << std::right << std::setw(14) << "allocations" 
+            << std::setw(14) << "live (kB)" << std::setw(14) << "peak (kB)"
+            << std::setw(12) << "live" << std::setw(12) << "peak" << '\n';
+        for (auto const &stats : detail::allocationStats) {
+            char const *stage = stats.stage.load();
+            if (!stage)
+                continue;
+            out << "[heap] " << std::setw(20) << std::left << stage 
+                << std::right << std::setw(14) << stats.allocations.load()
+                << std::setw(14) << stats.liveBytes.load() / 1024
+                << std::setw(14) << stats.peakBytes.load() / 1024
+                << std::setw(12) << stats.liveCount.load()
+                << std::setw(12) << stats.peakCount.load() << '\n';
+        }
+    }
+}
+
+#ifdef DEMO_TRACK_ALLOCATIONS
+
+// Replacement of the global allocation functions. The size and the slot
+// of the creating stage are stored in the 16 bytes before the returned
+// pointer. The header is 16 bytes for the default alignment of operator
+// new, and one alignment unit for the over-aligned allocations (the
+// std::align_val_t overloads), which are tracked as well.
+namespace demo::detail {
+
+    constexpr std::size_t allocationHeader = 16;
+
+    inline void *trackedAllocation(
+            std::size_t size, 
+            std::size_t align = allocationHeader
+            )
+    {
+        allocationTracking.store(true, std::memory_order_relaxed);
+        std::size_t const slot = allocationSlot();
+        std::size_t const header 
+            = (align > allocationHeader) ? align : allocationHeader;
+        // aligned_alloc() needs a size multiple of the alignment
+        void *base = (align > allocationHeader)
+            ? std::aligned_alloc(align, (header + size + align - 1) / align * align)
+            : std::malloc(header + size);
+        if (!base)
+            return nullptr;
+        char *ptr = static_cast<char*>(base) + header;
+        reinterpret_cast<std::size_t*>(ptr)[-2] = size;
+        reinterpret_cast<std::size_t*>(ptr)[-1] = slot;
+        recordAllocation(slot, size);
+        return ptr;
+    }
+
+    inline void trackedDeallocation(
+            void       *ptr, 
+            std::size_t align = allocationHeader
+            ) noexcept
+    {
+        if (!ptr)
+            return;
+        std::size_t const header 
+            = (align > allocationHeader) ? align : allocationHeader;
+        recordDeallocation(
+                static_cast<std::size_t*>(ptr)[-1], 
+                static_cast<std::size_t*>(ptr)[-2]
+                );
+        std::free(static_cast<char*>(ptr) - header);
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *ptr = demo::detail::trackedAllocation(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    if (void *ptr = demo::detail::trackedAllocation(
+                size, static_cast<std::size_t>(align)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    demo::detail::trackedDeallocation(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    demo::detail::trackedDeallocation(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    demo::detail::trackedDeallocation(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    demo::detail::trackedDeallocation(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t align) noexcept
+{
+    demo::detail::trackedDeallocation(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void *ptr, std::align_val_t align) noexcept
+{
+    demo::detail::trackedDeallocation(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t align) noexcept
+{
+    demo::detail::trackedDeallocation(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t align) noexcept
+{
+    demo::detail::trackedDeallocation(ptr, static_cast<std::size_t>(align));
+}
+
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Histogram that can be filled concurrently by the workers of
+ * parallelFor() and processFor() (see execution.h) without any lock.
+ *
+ * Each worker fills its own row of bins, padded to a cache line so that
+ * workers never write to the same line, and the rows are summed only
+ * when the histogram is read. The rows live in memory shared with
+ * forked workers, so a histogram filled in processFor() is seen by the
+ * parent process.
+ *
+ * The header is self-contained (with execution.h), copy it next to the
+ * scripts using it.
+ */
+#ifndef DEMO_HISTOGRAM_H_INCLUDED
+#define DEMO_HISTOGRAM_H_INCLUDED
+
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include "execution.h"
+
+namespace demo {
+
+    class ConcurrentHistogram {
+
+    public:
+
+        // nBins regular bins in [min, max[, plus underflow and overflow,
+        // for nWorkers workers (by default the workers of the execution
+        // context)
+        ConcurrentHistogram(
+                std::size_t t_nBins,
+                double      t_min,
+                double      t_max,
+                unsigned    nWorkers = workerCount()
+                )
+            :m_nBins(t_nBins),
+            m_min(t_min),
+            m_max(t_max),
+            m_invWidth(t_nBins / (t_max - t_min)),
+            m_nWorkers(nWorkers),
+            m_rowSize(paddedRowSize(t_nBins)),
+            m_data(2 * m_rowSize * nWorkers)
+        {}
+
+        std::size_t size() const { return m_nBins; }
+        double min() const { return m_min; }
+        double max() const { return m_max; }
+
+        // Adds the weight w at x, worker is the index given by
+        // parallelFor() or processFor() to the calling worker. Throws if
+        // the histogram was built for fewer workers.
+        void fill(unsigned worker, double x, double w = 1)
+        {
+            if (worker >= m_nWorkers)
+                throw std::out_of_range(
+                        "ConcurrentHistogram: worker index out of range");
+            std::size_t const bin = binIndex(x);
+            double *row = m_data.data() + 2 * m_rowSize * worker;
+            row[bin]             += w;
+            row[m_rowSize + bin] += w*w;
+        }
+
+        // Merged contents of the bins. Bin 0 is the underflow and bin
+        // size() + 1 the overflow.
+        double content(std::size_t bin) const
+        {
+            double sum = 0;
+            for (unsigned w = 0; w != m_nWorkers; ++w)
+                sum += m_data[2 * m_rowSize * w + bin];
+            return sum;
+        }
+
+        // Statistical error of a bin, sqrt(sum of w^2)
+        double error(std::size_t bin) const
+        {
+            double sum = 0;
+            for (unsigned w = 0; w != m_nWorkers; ++w)
+                sum += m_data[2 * m_rowSize * w + m_rowSize + bin];
+            return std::sqrt(sum);
+        }
+
+        // Merged contents of all the bins including under- and overflow
+        std::vector<double> contents() const
+        {
+            std::vector<double> res(m_nBins + 2);
+            for (unsigned w = 0; w != m_nWorkers; ++w) {
+                double const *row = m_data.data() + 2 * m_rowSize * w;
+                for (std::size_t i = 0; i != res.size(); ++i)
+                    res[i] += row[i];
+            }
+            return res;
+        }
+
+        // Lower edge of a regular bin i in [1, size()]
+        double lowerEdge(std::size_t bin) const
+        {
+            return m_min + (bin - 1) / m_invWidth;
+        }
+
+        // Writes "lower_edge upper_edge content error" for regular bins
+        void write(std::ostream &out) const
+        {
+            std::vector<double> const c = contents();
+            for (std::size_t i = 1; i <= m_nBins; ++i)
+                out << lowerEdge(i) << ' ' << lowerEdge(i + 1) << ' '
+                    << c[i] << ' ' << error(i) << '\n';
+        }
+
+    private:
+
+        static std::size_t paddedRowSize(std::size_t nBins)
+        {
+            // Multiple of 8 doubles (64 bytes, one cache line)
+            return (nBins + 2 + 7) / 8 * 8;
+        }
+
+        std::size_t binIndex(double x) const
+        {
+            if (!(x >= m_min))
+                return 0;
+            if (x >= m_max)
+                return m_nBins + 1;
+            std::size_t const bin = 1 + static_cast<std::size_t>((x - m_min) * m_invWidth);
+            return (bin > m_nBins) ? m_nBins : bin;
+        }
+
+        std::size_t         m_nBins;
+        double              m_min;
+        double              m_max;
+        double              m_invWidth;
+        unsigned            m_nWorkers;
+        std::size_t         m_rowSize;
+        SharedArray<double> m_data;
+    };
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Kinematic invariants of the generated functions.
+ *
+ * MARTY writes the kinematics of a process with the invariants
+ * s_ij = p_i.p_j of the external momenta. Momentum conservation and the
+ * on-shell conditions make most of them redundant, the functions below
+ * set the minimal independent set from physical quantities so that
+ * scripts never give inconsistent values to redundant invariants.
+ *
+ * The functions are templates on the param_t structure of the generated
+ * library. The header is self-contained, copy it next to the scripts
+ * using it.
+ */
+#ifndef DEMO_KINEMATICS_H_INCLUDED
+#define DEMO_KINEMATICS_H_INCLUDED
+
+namespace demo {
+
+    // Two-point functions (self-energies) with external momentum p:
+    // the only invariant is s_11 = p^2
+    template<class Params>
+    void setTwoPointKinematics(Params &params, double p2)
+    {
+        params.s_11 = p2;
+    }
+
+    // mu(p1) -> mu(p2) A(p3) with on-shell muons of mass m and a photon
+    // of virtuality q^2 = p3^2. With p3 = p1 - p2 the only invariant is
+    // s_12 = p1.p2 = m^2 - q^2/2 (s_12 = m^2 for an on-shell photon).
+    template<class Params>
+    void setVertexKinematics(Params &params, double m, double q2 = 0)
+    {
+        params.s_12 = m*m - q2/2;
+    }
+
+    // Photon virtuality of the vertex from s_12
+    inline double vertexQ2(double m, double s12)
+    {
+        return 2*m*m - 2*s12;
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Per-group headers for the libraries generated by MARTY.
+ *
+ * The header of a generated library (demolib.h for example) includes
+ * the declarations of all its functions, which dominates the compile 
+ * time of scripts using only a few of them in large libraries.
+ * LibraryGroups adds the functions to the library by group and writes,
+ * next to the generated headers:
+ *  - <lib>_<group>.h : declarations of the functions of one group
+ *  - <lib>_fwd.h     : declarations of all the functions
+ * Both only include the parameter structure and complex type of the
+ * library, so a script includes the declarations it calls and nothing
+ * else.
+ *
+ * writeBatchKernel() also writes <lib>_<group>_batch.h, a fused kernel
+ * evaluating all the functions of a group on a batch of parameter 
+ * points. The functions are called one after the other on each point,
+ * so that the loop integrals they share are computed once and found in
+ * the cache of LoopTools by the next function.
+ *
+ * addCompensatedSum() generates each term of a long sum as its own 
+ * function <name>_term_<k>. The group header then defines 
+ * <name>_terms(), filling the values of the terms, and <name>(), 
+ * summing them with the compensated summation of compensated.h instead
+ * of the naive sum of the generated code. MARTY generates the code of 
+ * a function from a single expression, so the terms cannot be summed 
+ * inside one generated function: <name>() makes one full call per term
+ * (parameters unpacked and loop integrals looked up in the cache of 
+ * LoopTools each time). bench_compensated.cpp prints this overhead per
+ * term against the single function of the naive sum, the compensated 
+ * sums are meant for accuracy checks rather than for scans.
+ *
+ * compensated.h is written in the include directory of the library by
+ * writeHeaders(), from its text embedded in the program at build time:
+ * the Makefile generates compensated_source.h, a string literal of 
+ * compensated.h.
+ */
+#ifndef DEMO_LIBRARY_GROUPS_H_INCLUDED
+#define DEMO_LIBRARY_GROUPS_H_INCLUDED
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "marty.h"
+
+namespace demo {
+
+    class LibraryGroups {
+
+    public:
+
+        LibraryGroups(mty::Library &t_lib, std::string t_libName)
+            :m_lib(t_lib),
+            m_libName(std::move(t_libName))
+        {}
+
+        void addFunction(
+                std::string const &group,
+                std::string const &name,
+                csl::Expr   const &expr
+                )
+        {
+            m_lib.addFunction(name, expr);
+            m_groups[group].push_back(name);
+        }
+
+        // Adds the terms of expr (or expr itself if it is not a sum) as
+        // separate functions, summed with compensation in the header of
+        // the group
+        void addCompensatedSum(
+                std::string const &group,
+                std::string const &name,
+                csl::Expr   const &expr
+                )
+        {
+            std::vector<csl::Expr> terms;
+            if (expr->getType() == csl::Type::Sum)
+                for (std::size_t i = 0; i != expr->size(); ++i)
+                    terms.push_back(expr->getArgument(i));
+            else
+                terms.push_back(expr);
+            for (std::size_t k = 0; k != terms.size(); ++k)
+                addFunction(group, name + "_term_" + std::to_string(k), terms[k]);
+            m_sums[group].push_back({name, terms.size()});
+        }
+
+        // Writes the headers, once the library is printed or built
+        void writeHeaders() const
+        {
+            std::vector<std::string> all;
+            for (auto const &[group, functions] : m_groups) {
+                auto const pos = m_sums.find(group);
+                writeHeader(
+                        m_libName + "_" + group, 
+                        functions, 
+                        (pos == m_sums.end()) ? std::vector<Sum>{} : pos->second
+                        );
+                all.insert(all.end(), functions.begin(), functions.end());
+            }
+            writeHeader(m_libName + "_fwd", all);
+            if (!m_sums.empty())
+                writeCompensatedHeader();
+        }
+
+        // Writes the fused kernel of a group, once the library is 
+        // printed or built. out[i*<group>_size + k] receives the k-th
+        // function of the group (in the order of addition) at the point
+        // params[i].
+        void writeBatchKernel(std::string const &group) const
+        {
+            std::vector<std::string> const &functions = m_groups.at(group);
+            std::string const name = m_libName + "_" + group + "_batch";
+            std::ofstream out(m_libName + "/include/" + name + ".h");
+            out << "// Generated by library_groups.h, do not edit\n";
+            out << "#ifndef " << headerGuard(name) << '\n';
+            out << "#define " << headerGuard(name) << "\n\n";
+            out << "#include <cstddef>\n";
+            out << "#include \"" << m_libName << "_" << group << ".h\"\n\n";
+            out << "namespace " << m_libName << " {\n\n";
+            out << "// Functions per point:\n";
+            for (std::size_t k = 0; k != functions.size(); ++k)
+                out << "//  " << k << " : " << functions[k] << '\n';
+            out << "constexpr std::size_t " << group << "_size = "
+                << functions.size() << ";\n\n";
+            out << "inline void " << group << "_batch(\n"
+                << "        param_t const *params,\n"
+                << "        std::size_t    n,\n"
+                << "        complex_t     *out\n"
+                << "        )\n{\n";
+            out << "    for (std::size_t i = 0; i != n; ++i) {\n";
+            out << "        complex_t *res = out + i*" << group << "_size;\n";
+            for (std::size_t k = 0; k != functions.size(); ++k)
+                out << "        res[" << k << "] = " << functions[k]
+                    << "(params[i]);\n";
+            out << "    }\n}\n\n}\n\n#endif\n";
+        }
+
+    private:
+
+        struct Sum {
+            std::string name;
+            std::size_t nTerms;
+        };
+
+        void writeHeader(
+                std::string              const &name,
+                std::vector<std::string> const &functions,
+                std::vector<Sum>         const &sums = {}
+                ) const
+        {
+            std::ofstream out(m_libName + "/include/" + name + ".h");
+            out << "// Generated by library_groups.h, do not edit\n";
+            out << "#ifndef " << headerGuard(name) << '\n';
+            out << "#define " << headerGuard(name) << "\n\n";
+            if (!sums.empty())
+                out << "#include <cstddef>\n#include \"compensated.h\"\n";
+            out << "#include \"common.h\"\n";
+            out << "#include \"params.h\"\n\n";
+            out << "namespace " << m_libName << " {\n\n";
+            for (auto const &function : functions)
+                out << "complex_t " << function << "(param_t const &params);\n";
+            for (auto const &sum : sums) {
+                out << "\nconstexpr std::size_t " << sum.name << "_size = "
+                    << sum.nTerms << ";\n\n";
+                out << "inline void " << sum.name 
+                    << "_terms(param_t const &params, complex_t *terms)\n{\n";
+                for (std::size_t k = 0; k != sum.nTerms; ++k)
+                    out << "    terms[" << k << "] = " << sum.name << "_term_" 
+                        << k << "(params);\n";
+                out << "}\n\n";
+                out << "inline complex_t " << sum.name 
+                    << "(param_t const &params)\n{\n";
+                out << "    complex_t terms[" << sum.name << "_size];\n";
+                out << "    " << sum.name << "_terms(params, terms);\n";
+                out << "    return demo::compensatedSum(terms, terms + "
+                    << sum.name << "_size);\n}\n";
+            }
+            out << "\n}\n\n#endif\n";
+        }
+
+        // The group headers with compensated sums include compensated.h,
+        // written from the text embedded in the program
+        void writeCompensatedHeader() const
+        {
+            static char const source[] =
+#include "compensated_source.h"
+                ;
+            std::ofstream(m_libName + "/include/compensated.h") << source;
+        }
+
+        static std::string headerGuard(std::string const &name)
+        {
+            std::string guard = name + "_H_INCLUDED";
+            std::transform(guard.begin(), guard.end(), guard.begin(),
+                    [](unsigned char c) { return std::toupper(c); });
+            return guard;
+        }
+
+        mty::Library                                    &m_lib;
+        std::string                                      m_libName;
+        std::map<std::string, std::vector<std::string>> m_groups;
+        std::map<std::string, std::vector<Sum>>         m_sums;
+    };
+}
+
+#endif
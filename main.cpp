@@ -2,12 +2,14 @@
  * This program presents the calculation of:
  *  - The muon self-energy
  *  - The muon anomalous magnetic moment
+ *  - The photon vacuum polarization from the muon loop
+ *  - The muon form factors F1(q^2) and F2(q^2) for an off-shell photon
  *
  *  These calculations are done in a simple QED model 
  *  containing only the muon and the photon, built from
  *  scratch at the beginning of the program.
  *
- *  The two calculations involve loop diagrams and we 
+ *  The calculations involve loop diagrams and we 
  *  voluntarily show more details than necessary to 
  *  make the reader a bit more used to the MARTY
  *  framework.
@@ -28,57 +30,66 @@
  *  https://marty.in2p3.fr/doc/marty-manual.pdf
  */
 #include "marty.h"
+#include "execution.h"
+#include "feynman_rule_index.h"
+#include "heap_profile.h"
+#include "library_groups.h"
+#include "profiler.h"
+#include "result_store.h"
 
 using namespace std;
 using namespace csl;
 using namespace mty;
 
-int main() 
-{
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    //  Model definition
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    
-    // For the general recipee for model building in MARTY see
-    // section 5.1
-
-    // Initialize the gauge group
-    // See section 5.2 of the manual
-    Model model;
-    model.addGaugedGroup(group::Type::U1, "em", constant_s("e"));
-    model.init();
-
-    model.renameParticle("A_em", "A"); // see section 5.5
-
-    // Create the muon particle
-    // See sections 2.1 and 2.2 for the creation of particles
-    // and their settings (representation, mass etc).
-    Particle muon = diracfermion_s("mu ; \\mu", model);
-    muon->setGroupRep("em", -1); // Charge -1 electromagnetic
-    muon->setMass(constant_s("m_mu")); 
-    model.addParticle(muon);
+// The program is organized as a pipeline of stages. Each stage is a 
+// function that takes its inputs as arguments and returns only the 
+// results needed by later stages. Amplitudes, WilsonSets and all 
+// intermediate expressions are local to their stage: they are released
+// as soon as the stage returns instead of living until the end of main().
+//
+// Only the symbolic results are released this way, the abbreviations
+// created during a stage are owned by MARTY and stay registered for the
+// whole program.
+//
+// Each stage labels itself with a demo::ProfileStage: when the program
+// is run with DEMO_PROFILE=main.folded, the samples of the profiler are
+// attributed to the stage they were taken in (see profiler.h).
 
-    // Refresh the model
-    model.refresh();
+// The small results of this program are simplified by expansion and 
+// factorization. The expanded form is computed once in the stage and 
+// kept in its results, as the library generation sums its terms with 
+// compensation (see generateLibrary()). The factored form is made from
+// it by factored() below, so that each form costs one deep copy of the
+// tree and the expansion is never done twice. The results they start
+// from are never modified, they may share subtrees with other results.
 
-    // Look at what you've done :)
-    Display(model); // Model in the terminal
+// Factored form of an expanded expression. DeepHardFactored() would 
+// copy its argument as well, the copy is made explicit here and factored
+// in place with DeepHardFactor() since it belongs only to this function.
+Expr factored(Expr const &expanded)
+{
+    Expr res = DeepCopy(expanded);
+    DeepHardFactor(res);
+    return res;
+}
 
-    // For the calculation and interpretation of Feynman rules
-    // see section 6.2
-    Show(model.getFeynmanRules()); // Feynman diagrams for the vertices
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Calculation of the muon self-energy
+/////////////////////////////////////////////
+/////////////////////////////////////////////
 
-    cout << "Press enter to launch the calculation of the"
-              << " muon self-energy ...\n";
-    cin.get();
+// Results of the self-energy stage used by the library generation
+struct SelfEnergyResults {
+    Expr mTerm;    // Coefficient of the m_mu term
+    Expr pTerm;    // Coefficient of the \slashed{p} term
+    Expr squared;  // Squared amplitude
+    Expr expanded; // Same with abbreviations evaluated, expanded
+};
 
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    //  Calculation of the muon self-energy
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
+SelfEnergyResults computeSelfEnergy(Model &model)
+{
+    demo::ProfileStage stage("self_energy");
 
     cout << "###############################\n";
     cout << "####  MUON SELF-ENERGY\n";
@@ -116,8 +127,9 @@ int main()
     // Th self-energy contains to terms, one proportional to m_mu
     // and one proportional to \shashed{p} with p the muon momentum.
     // We obtain the two corresponding coefficients in he following.
-    Expr muonSelfEnergy_mTerm = wilsonsSelfEnergy[0].coef.getCoefficient();
-    Expr muonSelfEnergy_pTerm = wilsonsSelfEnergy[1].coef.getCoefficient();
+    SelfEnergyResults results;
+    results.mTerm = wilsonsSelfEnergy[0].coef.getCoefficient();
+    results.pTerm = wilsonsSelfEnergy[1].coef.getCoefficient();
 
     // We evaluate the abbreviations to see the exact expression. The list
     // of abbreviations used by MARTY can alo be displayed at any time 
@@ -125,37 +137,61 @@ int main()
     // DisplayAbbreviations();
     cout << "DECOMPOSITION OF THE TWO CONTRIBUTIONS:\n";
     cout << "M-term contribution: " 
-              << Evaluated(muonSelfEnergy_mTerm, eval::abbreviation) 
+              << Evaluated(results.mTerm, eval::abbreviation) 
               << endl;
     cout << "P-term contribution: " 
-              << Evaluated(muonSelfEnergy_pTerm, eval::abbreviation) 
+              << Evaluated(results.pTerm, eval::abbreviation) 
               << endl;
     cout << endl;
 
     // We can also compute the squared amplitude if we want
     // See section 6.5 for the calculation of squared amplitudes
-    Expr squaredSelfEnergy = model.computeSquaredAmplitude(selfEnergy); 
+    results.squared = model.computeSquaredAmplitude(selfEnergy); 
     cout << "SQUARED AMPLITUDE RESULT:\n";
     // Evaluate the abbreviations
-    Expr evaluatedSelfEnergy = Evaluated(squaredSelfEnergy, eval::abbreviation);
+    Expr evaluatedSelfEnergy = Evaluated(results.squared, eval::abbreviation);
     // Simplify by expanding and factoring again
     // As explained below, this is not recommended in general (for large expressions
     // in particular)
-    Expr simplifiedSelfEnergy = DeepHardFactored(DeepExpanded(evaluatedSelfEnergy));
-    cout << "\nM2              = " << squaredSelfEnergy << endl;
+    results.expanded = DeepExpanded(evaluatedSelfEnergy);
+    Expr simplifiedSelfEnergy = factored(results.expanded);
+    cout << "\nM2              = " << results.squared << endl;
     cout << "\nM2 [evaluated]  = " << evaluatedSelfEnergy << endl;
     cout << "\nM2 [simplified] = " << simplifiedSelfEnergy << endl;
 
-    cout << "\nPress enter to launch the calculation of (g-2) ...\n";
-    cin.get();
+    // Nodes of the squared amplitude by type, before and after the 
+    // evaluation of abbreviations (DEMO_HEAP_PROFILE=1, see 
+    // heap_profile.h)
+    if (demo::heapProfileEnabled()) {
+        demo::printNodeCensus(cout, "M2", results.squared);
+        demo::printNodeCensus(cout, "M2 [evaluated]", evaluatedSelfEnergy);
+        demo::printAllocations(cout);
+    }
+
+    // selfEnergy, wilsonsSelfEnergy and the evaluated and simplified 
+    // squared amplitudes are only used for display, they are released here
+    return results;
+}
+
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Calculation of the muon anomalous
+//  magnetic moment (g-2)
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+
+// Results of the (g-2) stage used by the library generation
+struct MagneticMomentResults {
+    Expr coefficient; // Coefficient of the magnetic operator
+    Expr evaluated;   // Same with abbreviations evaluated
+    Expr expanded;    // Same after expansion
+    Expr simplified;  // Same after expansion and factorization
+};
+
+MagneticMomentResults computeMagneticMoment(Model &model)
+{
+    demo::ProfileStage stage("magnetic_moment");
 
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    //  Calculation of the muon anomalous
-    //  magnetic moment (g-2)
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    
     cout << "###############################\n";
     cout << "####  MUON MAGNETIC MOMENT\n";
     cout << "###############################\n\n";
@@ -183,38 +219,231 @@ int main()
     );
     // Finally we extract the coefficient of the particular operator
     // we received from chromoMagneticOperator()
-    Expr muonMagneticMoment = getWilsonCoefficient(
+    MagneticMomentResults results;
+    results.coefficient = getWilsonCoefficient(
             wilsonsMuonVertex, 
             muonMagOp
     );
 
-    cout << "MAGNETIC MOMENT RESULTS:";
+    // Remove abbreviations using Evaluated(expr, eval::abbreviation)
+    // Each call expands all the abbreviations of the expression again,
+    // so we do it only once and re-use the result below
+    results.evaluated = Evaluated(results.coefficient, eval::abbreviation);
+
+    // With on-shell muons and photon, momentum conservation fixes the 
+    // only kinematic invariant s_12 = p1.p2 = m_mu^2. Replacing it early
+    // lets equivalent terms cancel during the simplification below and
+    // removes s_12 from the parameters of the functions generated from 
+    // the evaluated result (mu_magnetic_vertex_eval, _simpli and 
+    // _expanded). mu_magnetic_vertex, generated from the coefficient 
+    // with its abbreviations, and the form factors still take s_12. The
+    // replacement is done once abbreviations are evaluated so that it 
+    // also reaches the arguments of the loop integrals.
+    Expr m_mu = model.getParticle("mu")->getMass();
+    results.evaluated = Replaced(
+            results.evaluated, 
+            constant_s("s_12"), 
+            m_mu*m_mu
+            );
+    // The generated functions would otherwise silently read s_12: check
+    // that Replaced() left no occurrence of it
+    bool const dependsOnS12 = AnyOfLeafs(
+            results.evaluated, 
+            [](Expr const &leaf) {
+                return leaf->getType() == csl::Type::Constant
+                    && leaf->getName() == "s_12";
+            });
+    if (dependsOnS12)
+        throw runtime_error("s_12 is still present in the (g-2) result");
+
+    cout << "MAGNETIC MOMENT RESULTS:\n";
     cout << "Muon magnetic moment              = "
-              << Evaluated(muonMagneticMoment, eval::abbreviation)
+              << results.coefficient
               << endl;
-    // Remove abbreviations using Evaluated(expr, eval::abbreviation)
-    Expr evaluatedMagneticMoment = Evaluated(muonMagneticMoment, eval::abbreviation);
     cout << "Muon magnetic moment [evaluated]  = "
-              << evaluatedMagneticMoment
+              << results.evaluated
               << endl;
 
-    // Simplify small expressions with DeepHardFactored(DeepExpanded())
+    // Simplify small expressions by expanding and factoring, the 
+    // expanded form is kept for the library generation (see factored())
     // This is however not recommended on large expressions!
     // For pedagocical purposes and on small results this is however really good :)
-    Expr simplifiedMagneticMoment = DeepHardFactored(DeepExpanded(evaluatedMagneticMoment));
+    results.expanded   = DeepExpanded(results.evaluated);
+    results.simplified = factored(results.expanded);
     cout << "Muon magnetic moment [simplified] = "
-              << simplifiedMagneticMoment
+              << results.simplified
               << endl;
 
-    cout << "\nPress enter to launch the library generation ...\n";
-    cin.get();
+    if (demo::heapProfileEnabled()) {
+        demo::printNodeCensus(cout, "magnetic moment", results.coefficient);
+        demo::printNodeCensus(cout, "magnetic moment [evaluated]", results.evaluated);
+        demo::printAllocations(cout);
+    }
 
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
-    //  Generation of the library
-    //  (this is the easy part :D)
-    /////////////////////////////////////////////
-    /////////////////////////////////////////////
+    // wilsonsMuonVertex is released here
+    return results;
+}
+
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Calculation of the photon vacuum
+//  polarization (muon loop)
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+
+// Results of the vacuum polarization stage used by the library generation
+struct VacuumPolarizationResults {
+    Expr gTerm; // Coefficient of the g^{mu,nu} term
+};
+
+VacuumPolarizationResults computeVacuumPolarization(Model &model)
+{
+    demo::ProfileStage stage("vacuum_polarization");
+
+    cout << "###############################\n";
+    cout << "####  PHOTON VACUUM POLARIZATION\n";
+    cout << "###############################\n\n";
+
+    // Same procedure as for the muon self-energy, with off-shell photons
+    Amplitude vacuumPolarization = model.computeAmplitude(
+            OneLoop,
+            {Incoming(OffShell("A")), Outgoing(OffShell("A"))}
+            );
+    cout << "AMPLITUDE RESULTS:\n";
+    Display(vacuumPolarization);
+    Show(vacuumPolarization);
+
+    // The amplitude is decomposed over the two Lorentz structures 
+    // g^{mu,nu} and p^mu*p^nu, contracted with the photon polarizations.
+    // As for the self-energy, the order of the terms is the one displayed 
+    // here and the first term is the g^{mu,nu} one. Its coefficient 
+    // -q^2*Pi(q^2) gives the vacuum polarization Pi(q^2), from which the 
+    // running coupling alpha(q^2) is obtained (see 
+    // example_running_alpha.cpp).
+    cout << "WILSON COEFFICIENT RESULTS:\n";
+    WilsonSet wilsonsVacuumPolarization 
+        = model.getWilsonCoefficients(vacuumPolarization);
+    Display(wilsonsVacuumPolarization);
+
+    VacuumPolarizationResults results;
+    results.gTerm = wilsonsVacuumPolarization[0].coef.getCoefficient();
+    cout << "g-term contribution: " 
+              << Evaluated(results.gTerm, eval::abbreviation) 
+              << endl;
+
+    return results;
+}
+
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Calculation of the muon form factors
+//  F1(q^2) and F2(q^2)
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+
+// Results of the form factor stage used by the library generation
+struct FormFactorResults {
+    Expr vectorTerm;   // Coefficient of the gamma^mu current (F1)
+    Expr magneticTerm; // Coefficient of the magnetic operator (F2)
+};
+
+FormFactorResults computeFormFactors(Model &model)
+{
+    demo::ProfileStage stage("form_factors");
+
+    cout << "###############################\n";
+    cout << "####  MUON FORM FACTORS\n";
+    cout << "###############################\n\n";
+
+    // Same vertex as for (g-2) but with an off-shell photon, so that the
+    // coefficients depend on the photon virtuality q^2. With on-shell 
+    // muons and momentum conservation q^2 = 2*m_mu^2 - 2*s_12 and s_12 
+    // is the only kinematic variable of the result.
+    WilsonSet wilsonsFormFactors = model.computeWilsonCoefficients(
+            OneLoop,
+            {Incoming("mu"), Outgoing("mu"), Outgoing(OffShell("A"))}
+            );
+    cout << "WILSON COEFFICIENTS RESULTS:\n";
+    Display(wilsonsFormFactors);
+
+    FormFactorResults results;
+    // The Pauli form factor F2 is given by the magnetic operator as for 
+    // the (g-2) calculation
+    vector<Wilson> muonMagOp = chromoMagneticOperator(
+            model, 
+            wilsonsFormFactors, 
+            DiracCoupling::S
+    );
+    results.magneticTerm = getWilsonCoefficient(wilsonsFormFactors, muonMagOp);
+    // The Dirac form factor F1 is given by the coefficient of the vector
+    // current, the first term of the set displayed above
+    results.vectorTerm = wilsonsFormFactors[0].coef.getCoefficient();
+
+    cout << "Vector current coefficient    = " << results.vectorTerm << endl;
+    cout << "Magnetic operator coefficient = " << results.magneticTerm << endl;
+
+    return results;
+}
+
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Generation of the library
+//  (this is the easy part :D)
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+
+// Functions of demolib by group, so that scripts include only the 
+// declarations of the group they use (demolib_self_energy.h, ...) 
+// instead of demolib.h, see library_groups.h
+//
+// The expanded forms of the squared self-energy and of (g-2) are long 
+// sums with large cancellations between their terms. They are summed 
+// with compensation (Neumaier) in demolib_compensated.h, see 
+// bench_compensated.cpp for the accuracy and the cost compared to the 
+// naive sum.
+struct LibraryFunction {
+    string group;
+    string function;
+    bool   compensated; // Generated with addCompensatedSum()
+};
+
+vector<LibraryFunction> const libraryFunctions {
+    {"self_energy",         "mu_self_e_mterm",             false},
+    {"self_energy",         "mu_self_e_pterm",             false},
+    {"self_energy",         "mu_self_e_squared",           false},
+    {"magnetic",            "mu_magnetic_vertex",          false},
+    {"magnetic",            "mu_magnetic_vertex_eval",     false},
+    {"magnetic",            "mu_magnetic_vertex_simpli",   false},
+    {"vacuum_polarization", "photon_self_e_gterm",         false},
+    {"form_factors",        "mu_vertex_vector_q2",         false},
+    {"form_factors",        "mu_vertex_magnetic_q2",       false},
+    {"compensated",         "mu_self_e_squared_expanded",  true},
+    {"compensated",         "mu_magnetic_vertex_expanded", true}
+};
+
+// Generates demolib and returns the expression of each function by name
+map<string, Expr> generateLibrary(
+        SelfEnergyResults         const &selfEnergy,
+        MagneticMomentResults     const &magneticMoment,
+        VacuumPolarizationResults const &vacuumPolarization,
+        FormFactorResults         const &formFactors
+        )
+{
+    demo::ProfileStage stage("library");
+
+    map<string, Expr> const expressions {
+        {"mu_self_e_mterm",             selfEnergy.mTerm},
+        {"mu_self_e_pterm",             selfEnergy.pTerm},
+        {"mu_self_e_squared",           selfEnergy.squared},
+        {"mu_magnetic_vertex",          magneticMoment.coefficient},
+        {"mu_magnetic_vertex_eval",     magneticMoment.evaluated},
+        {"mu_magnetic_vertex_simpli",   magneticMoment.simplified},
+        {"photon_self_e_gterm",         vacuumPolarization.gTerm},
+        {"mu_vertex_vector_q2",         formFactors.vectorTerm},
+        {"mu_vertex_magnetic_q2",       formFactors.magneticTerm},
+        {"mu_self_e_squared_expanded",  selfEnergy.expanded},
+        {"mu_magnetic_vertex_expanded", magneticMoment.expanded}
+    };
 
     // For the code generation and to use the generated library
     // see the chapter 7 of the manual :))
@@ -226,20 +455,188 @@ int main()
     lib.cleanExistingSources();  
 
     // We add the functions one by one, giving only the name and symbolic
-    // expression to compile
-    lib.addFunction("mu_self_e_mterm", muonSelfEnergy_mTerm);
-    lib.addFunction("mu_self_e_pterm", muonSelfEnergy_pTerm);
-    lib.addFunction("mu_self_e_squared", squaredSelfEnergy);
-    lib.addFunction("mu_magnetic_vertex", muonMagneticMoment);
-    lib.addFunction("mu_magnetic_vertex_eval", evaluatedMagneticMoment);
-    lib.addFunction("mu_magnetic_vertex_simpli", simplifiedMagneticMoment);
+    // expression to compile. 
+    demo::LibraryGroups groups(lib, "demolib");
+    for (LibraryFunction const &f : libraryFunctions) {
+        Expr const &expr = expressions.at(f.function);
+        if (f.compensated)
+            groups.addCompensatedSum(f.group, f.function, expr);
+        else
+            groups.addFunction(f.group, f.function, expr);
+    }
 
     // Make MARTY build automatically the library :)
     // We could also use a simple
     // lib.print();
     // if we want to compile th library later on (useful for large libraries)
-    lib.build();
+    //
+    // The library is compiled with as many jobs as workers in the 
+    // execution context (see execution.h)
+    lib.build(demo::workerCount());
+    groups.writeHeaders();
+
+    return expressions;
+}
+
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+//  Local store of the results
+/////////////////////////////////////////////
+/////////////////////////////////////////////
+
+// Coefficients of the pipeline recorded in the local store (see 
+// result_store.h). All of them are generated in demolib, which is 
+// cleaned and rebuilt as a whole: the pipeline is skipped only if all 
+// of them are found. Functions derived from these coefficients 
+// (mu_magnetic_vertex_eval, the compensated sums, ...) are regenerated
+// with them and have no entry of their own, but the list of functions
+// and groups of demolib is part of every signature: a library laid out
+// differently is not reused.
+struct StoreEntry {
+    string function; // Name of the generated function
+    string process;  // Insertions of the calculation
+    string options;  // Term of the process and kinematics
+};
+
+vector<StoreEntry> const storeEntries {
+    {"mu_self_e_mterm",       "mu -> mu",   "off-shell, m-term"},
+    {"mu_self_e_pterm",       "mu -> mu",   "off-shell, p-term"},
+    {"mu_self_e_squared",     "mu -> mu",   "off-shell, squared"},
+    {"mu_magnetic_vertex",    "mu -> mu A", "magnetic"},
+    {"photon_self_e_gterm",   "A -> A",     "off-shell, g-term"},
+    {"mu_vertex_vector_q2",   "mu -> mu A", "off-shell A, vector"},
+    {"mu_vertex_magnetic_q2", "mu -> mu A", "off-shell A, magnetic"}
+};
+
+// Functions and groups of demolib as written in the signatures
+string libraryLayout()
+{
+    string layout;
+    for (LibraryFunction const &f : libraryFunctions)
+        layout += "; " + f.group + "/" + f.function;
+    return layout;
+}
+
+int main() 
+{
+    // Samples the whole program if DEMO_PROFILE is set, the folded 
+    // stacks are written when main() returns. Samples taken outside of 
+    // the stages below (model building) are attributed to "main".
+    demo::Profiler profiler;
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Model definition
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    
+    // For the general recipee for model building in MARTY see
+    // section 5.1
+
+    // Initialize the gauge group
+    // See section 5.2 of the manual
+    Model model;
+    model.addGaugedGroup(group::Type::U1, "em", constant_s("e"));
+    model.init();
+
+    model.renameParticle("A_em", "A"); // see section 5.5
 
+    // Fix the gauge of the photon explicitly. In the Feynman gauge the
+    // propagator has no k^mu*k^nu term: diagrams are smaller and there
+    // are no gauge-dependent terms to cancel at the end of the 
+    // calculation. Gauge independence can be checked with gauge_check.cpp
+    model.setGaugeChoice("A", gauge::Type::Feynman);
+
+    // Create the muon particle
+    // See sections 2.1 and 2.2 for the creation of particles
+    // and their settings (representation, mass etc).
+    Particle muon = diracfermion_s("mu ; \\mu", model);
+    muon->setGroupRep("em", -1); // Charge -1 electromagnetic
+    muon->setMass(constant_s("m_mu")); 
+    model.addParticle(muon);
+
+    // Refresh the model
+    // refresh() processes the whole Lagrangian again (mass terms,
+    // mixings, Feynman rules), it is not incremental: add all the
+    // particles and couplings first and refresh once
+    model.refresh();
+
+    // Look at what you've done :)
+    Display(model); // Model in the terminal
+
+    // For the calculation and interpretation of Feynman rules
+    // see section 6.2
+    Show(model.getFeynmanRules()); // Feynman diagrams for the vertices
+
+    // The rules can be indexed by field content to find the vertices of 
+    // a set of fields without going through the whole list, which 
+    // matters in models with many vertices (see feynman_rule_index.h)
+    demo::FeynmanRuleIndex ruleIndex(model.getFeynmanRules());
+    for (mty::FeynmanRule const *rule : ruleIndex.find({"mu", "mu^*", "A"}))
+        cout << "mu-mu-A vertex: " << rule->getExpr() << endl;
+
+    // Nothing to compute if demolib was already generated for the same
+    // model and reuse is enabled with DEMO_REUSE_STORE=1
+    demo::ResultStore store;
+    vector<string> signatures;
+    bool allStored = true;
+    for (StoreEntry const &entry : storeEntries) {
+        signatures.push_back(demo::ResultStore::signature(
+                    model, entry.process, "OneLoop", 
+                    entry.options + libraryLayout()));
+        allStored = allStored && store.find(signatures.back());
+    }
+    if (allStored) {
+        cout << "Results already generated in demolib (DEMO_REUSE_STORE "
+             << "is set), unset it to compute them again" << endl;
+        return 0;
+    }
+
+    cout << "Press enter to launch the calculation of the"
+              << " muon self-energy ...\n";
+    cin.get();
+
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+    //  Pipeline
+    /////////////////////////////////////////////
+    /////////////////////////////////////////////
+
+    SelfEnergyResults selfEnergy = computeSelfEnergy(model);
+
+    cout << "\nPress enter to launch the calculation of (g-2) ...\n";
+    cin.get();
+
+    MagneticMomentResults magneticMoment = computeMagneticMoment(model);
+
+    cout << "\nPress enter to launch the calculation of the"
+              << " vacuum polarization ...\n";
+    cin.get();
+
+    VacuumPolarizationResults vacuumPolarization 
+        = computeVacuumPolarization(model);
+
+    cout << "\nPress enter to launch the calculation of the"
+              << " form factors ...\n";
+    cin.get();
+
+    FormFactorResults formFactors = computeFormFactors(model);
+
+    cout << "\nPress enter to launch the library generation ...\n";
+    cin.get();
+
+    map<string, Expr> const generated = generateLibrary(
+            selfEnergy, 
+            magneticMoment, 
+            vacuumPolarization, 
+            formFactors
+            );
+    for (size_t i = 0; i != storeEntries.size(); ++i)
+        store.insert(
+                signatures[i], 
+                {storeEntries[i].function, "demolib"}, 
+                generated.at(storeEntries[i].function)
+                );
 
     return 0;
 }
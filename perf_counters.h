@@ -0,0 +1,217 @@
+/*
+ * Hardware performance counters read with perf_event_open(2).
+ *
+ * PerfCounters counts, for the calling thread and the threads it 
+ * creates, the instructions, cycles, cache misses and branch misses 
+ * between start() and stop(). The instructions per cycle and the cache
+ * misses per instruction tell whether a piece of code is compute-bound
+ * or memory-bound.
+ *
+ * The four events are opened as one group led by the instructions: the
+ * kernel schedules them together, so their ratios are taken over the 
+ * same intervals. When the PMU has fewer counters than needed, the 
+ * group only runs part of the time (multiplexing) and the values are
+ * scaled by the time enabled over the time running, the fraction being
+ * reported with them. Kernels refusing inherited group reads only count
+ * the calling thread.
+ *
+ * Only user-space events are counted, which is allowed with the default
+ * kernel.perf_event_paranoid = 2. Counters that cannot be opened (no
+ * permission, virtual machine without PMU, ...) are reported as 
+ * unavailable instead of failing.
+ *
+ * The header is standalone, copy it next to the scripts using it.
+ */
+#ifndef DEMO_PERF_COUNTERS_H_INCLUDED
+#define DEMO_PERF_COUNTERS_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ios>
+#include <ostream>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace demo {
+
+    struct PerfCounts {
+        static constexpr std::size_t nEvents = 4;
+        // instructions, cycles, cache misses, branch misses, -1 if the 
+        // counter is unavailable
+        std::array<std::int64_t, nEvents> values {-1, -1, -1, -1};
+        // Fraction of the time the counters were running, the values
+        // are scaled to the full time when it is below 1
+        double running = 1;
+
+        std::int64_t instructions() const { return values[0]; }
+        std::int64_t cycles()       const { return values[1]; }
+        std::int64_t cacheMisses()  const { return values[2]; }
+        std::int64_t branchMisses() const { return values[3]; }
+
+        bool available() const { return values[0] >= 0 || values[1] >= 0; }
+
+        double ipc() const
+        {
+            return (instructions() >= 0 && cycles() > 0) ?
+                double(instructions()) / cycles() : 0;
+        }
+
+        // Cache misses per thousand instructions
+        double cacheMissesPerKiloInstruction() const
+        {
+            return (instructions() > 0 && cacheMisses() >= 0) ?
+                1000. * cacheMisses() / instructions() : 0;
+        }
+
+        PerfCounts &operator+=(PerfCounts const &other)
+        {
+            for (std::size_t i = 0; i != nEvents; ++i)
+                if (values[i] >= 0 && other.values[i] >= 0)
+                    values[i] += other.values[i];
+            running = std::min(running, other.running);
+            return *this;
+        }
+    };
+
+    inline std::ostream &operator<<(std::ostream &out, PerfCounts const &counts)
+    {
+        if (!counts.available())
+            return out << "counters unavailable";
+        static char const *names[PerfCounts::nEvents] = {
+            "instructions", "cycles", "cache-misses", "branch-misses"
+        };
+        for (std::size_t i = 0; i != PerfCounts::nEvents; ++i) {
+            out << names[i] << ' ';
+            if (counts.values[i] >= 0)
+                out << counts.values[i];
+            else
+                out << '-';
+            out << ", ";
+        }
+        std::streamsize const precision = out.precision(3);
+        out << "IPC " << counts.ipc() << ", cache-misses/kinstr " 
+            << counts.cacheMissesPerKiloInstruction();
+        if (counts.running < 1)
+            out << " (multiplexed, counted " << 100 * counts.running 
+                << "% of the time and scaled)";
+        out.precision(precision);
+        return out;
+    }
+
+    class PerfCounters {
+
+    public:
+
+        PerfCounters()
+        {
+            // Inherited counters are not readable as a group on older 
+            // kernels, the group is then opened for this thread only
+            if (!open(true) && errno == EINVAL)
+                open(false);
+        }
+
+        PerfCounters(PerfCounters const &) = delete;
+        PerfCounters &operator=(PerfCounters const &) = delete;
+
+        ~PerfCounters()
+        {
+            close();
+        }
+
+        void start()
+        {
+            if (m_leader < 0)
+                return;
+            ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        // Stops the counters and returns their values since start()
+        PerfCounts stop()
+        {
+            PerfCounts counts;
+            if (m_leader < 0)
+                return counts;
+            ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            // PERF_FORMAT_GROUP with the times: number of events, time
+            // enabled, time running, then one value per event in the 
+            // order they joined the group
+            std::uint64_t data[3 + PerfCounts::nEvents];
+            ssize_t const size = read(m_leader, data, sizeof(data));
+            if (size < ssize_t(3 * sizeof(std::uint64_t)) 
+                    || data[0] != m_events.size() || data[2] == 0)
+                return counts;
+            double const running = double(data[2]) / data[1];
+            counts.running = std::min(1., running);
+            for (std::size_t j = 0; j != m_events.size(); ++j)
+                counts.values[m_events[j]] = static_cast<std::int64_t>(
+                        data[3 + j] / counts.running + 0.5);
+            return counts;
+        }
+
+    private:
+
+        // Opens the group, the instructions leading it. Returns false 
+        // if the leader cannot be opened, events the machine does not
+        // support are left out of the group.
+        bool open(bool inherit)
+        {
+            static constexpr std::uint64_t configs[PerfCounts::nEvents] = {
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+            for (std::size_t i = 0; i != PerfCounts::nEvents; ++i) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size           = sizeof(attr);
+                attr.type           = PERF_TYPE_HARDWARE;
+                attr.config         = configs[i];
+                attr.disabled       = (i == 0);
+                attr.inherit        = inherit;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv     = 1;
+                attr.read_format    = PERF_FORMAT_GROUP 
+                                    | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                int const fd = static_cast<int>(syscall(
+                            __NR_perf_event_open, &attr, 0, -1, 
+                            (i == 0) ? -1 : m_leader, 0));
+                if (i == 0 && fd < 0)
+                    return false;
+                if (fd < 0)
+                    continue;
+                if (i == 0)
+                    m_leader = fd;
+                m_fd[i] = fd;
+                m_events.push_back(i);
+            }
+            return true;
+        }
+
+        void close()
+        {
+            for (int &fd : m_fd)
+                if (fd >= 0) {
+                    ::close(fd);
+                    fd = -1;
+                }
+            m_leader = -1;
+            m_events.clear();
+        }
+
+        int                                  m_leader = -1;
+        std::array<int, PerfCounts::nEvents> m_fd {-1, -1, -1, -1};
+        std::vector<std::size_t>             m_events; // Order in the group
+    };
+}
+
+#endif
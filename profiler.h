@@ -0,0 +1,325 @@
+/*
+ * Opt-in sampling profiler for the MARTY programs of this demo.
+ *
+ * When the environment variable DEMO_PROFILE is set to a file name, a
+ * Profiler object samples the call stack of the program on SIGPROF 
+ * (every millisecond of CPU time by default, DEMO_PROFILE_HZ=n for n 
+ * samples per second) and, when it is destroyed, writes the samples in
+ * the folded format of flame graphs:
+ *     stage;outer_function;...;inner_function count
+ * Identical stacks are counted together as they are sampled, in a table
+ * of distinct stacks allocated beforehand: the memory of the profiler 
+ * depends on the number of distinct stacks only, not on the duration of
+ * the run. The table holds 32768 stacks by default, DEMO_PROFILE_STACKS=n
+ * sets its size. Samples of new stacks found once it is full are 
+ * dropped and reported.
+ * The first frame of each stack is the pipeline stage the sample was 
+ * taken in, set with ProfileStage objects, so that the samples are 
+ * attributed to both the stages of the program and the internal 
+ * functions of MARTY and CSL. The file is read directly by 
+ * flamegraph.pl or speedscope.
+ *
+ * With DEMO_PERF_COUNTERS=1, each ProfileStage also reads the hardware
+ * counters of perf_counters.h (instructions, cycles, cache and branch
+ * misses) over its lifetime and prints them at the end of the stage.
+ *
+ * Without DEMO_PROFILE and DEMO_PERF_COUNTERS nothing is measured and 
+ * ProfileStage only stores two pointers. 
+ *
+ * Function names are resolved with dladdr(): functions of shared 
+ * libraries (libmarty, libcsl, ...) are always named, functions of the
+ * program itself only when it is linked with -rdynamic.
+ */
+#ifndef DEMO_PROFILER_H_INCLUDED
+#define DEMO_PROFILER_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "perf_counters.h"
+
+namespace demo {
+
+    namespace detail {
+
+        // Distinct stack of the table and its number of samples. An
+        // entry is claimed by the first sample of its stack (state 0 to
+        // 1), written, then published (state 2) before other samples 
+        // compare their stack to it.
+        struct ProfileStack {
+            static constexpr int maxDepth = 48;
+            std::atomic<int>         state {0};
+            std::uint64_t            hash;
+            char const              *stage;
+            int                      depth;
+            void                    *frames[maxDepth];
+            std::atomic<std::size_t> count {0};
+        };
+
+        struct ProfilerState {
+            std::atomic<char const*> stage {"main"};
+            ProfileStack            *stacks   = nullptr;
+            std::size_t              capacity = 0; // Power of 2
+            std::atomic<std::size_t> dropped {0};
+        };
+
+        inline ProfilerState &profilerState()
+        {
+            static ProfilerState state;
+            return state;
+        }
+
+        inline std::uint64_t stackHash(
+                char const  *stage,
+                void *const *frames,
+                int          depth
+                )
+        {
+            std::uint64_t h = 14695981039346656037ull;
+            h = (h ^ reinterpret_cast<std::uintptr_t>(stage)) * 1099511628211ull;
+            for (int i = 0; i != depth; ++i)
+                h = (h ^ reinterpret_cast<std::uintptr_t>(frames[i])) 
+                    * 1099511628211ull;
+            return h ^ (h >> 32);
+        }
+
+        inline bool sameStack(
+                ProfileStack const &entry,
+                std::uint64_t       hash,
+                char const         *stage,
+                void *const        *frames,
+                int                 depth
+                )
+        {
+            return entry.hash == hash && entry.stage == stage
+                && entry.depth == depth
+                && std::equal(frames, frames + depth, entry.frames);
+        }
+
+        // Only async-signal-safe operations: the table is allocated 
+        // beforehand, entries are claimed and counted with lock-free 
+        // atomics, and backtrace() is loaded by a first call outside of
+        // the handler. An entry being written by another thread is 
+        // skipped, the same stack may then get a second entry, merged 
+        // with the first one when the profile is written.
+        inline void profileHandler(int)
+        {
+            ProfilerState &state = profilerState();
+            if (state.capacity == 0)
+                return;
+            char const *stage = state.stage.load(std::memory_order_relaxed);
+            void *frames[ProfileStack::maxDepth];
+            int const depth = backtrace(frames, ProfileStack::maxDepth);
+            std::uint64_t const hash = stackHash(stage, frames, depth);
+            std::size_t const mask = state.capacity - 1;
+            for (std::size_t probe = 0; probe != state.capacity; ++probe) {
+                ProfileStack &entry = state.stacks[(hash + probe) & mask];
+                int current = entry.state.load(std::memory_order_acquire);
+                if (current == 0) {
+                    if (entry.state.compare_exchange_strong(
+                                current, 1, std::memory_order_acquire)) {
+                        entry.hash  = hash;
+                        entry.stage = stage;
+                        entry.depth = depth;
+                        std::copy(frames, frames + depth, entry.frames);
+                        entry.count.store(1, std::memory_order_relaxed);
+                        entry.state.store(2, std::memory_order_release);
+                        return;
+                    }
+                }
+                if (current == 2 && sameStack(entry, hash, stage, frames, depth)) {
+                    entry.count.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            state.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        inline std::string frameName(void *address)
+        {
+            Dl_info info;
+            if (dladdr(address, &info) && info.dli_sname) {
+                int status;
+                std::unique_ptr<char, void(*)(void*)> demangled(
+                        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status),
+                        std::free);
+                return (status == 0) ? demangled.get() : info.dli_sname;
+            }
+            std::ostringstream out;
+            if (dladdr(address, &info) && info.dli_fname) {
+                char const *slash = std::strrchr(info.dli_fname, '/');
+                out << (slash ? slash + 1 : info.dli_fname) << "+0x" 
+                    << std::hex << (static_cast<char*>(address) 
+                            - static_cast<char*>(info.dli_fbase));
+            }
+            else
+                out << address;
+            return out.str();
+        }
+
+        inline bool perfCountersEnabled()
+        {
+            static bool const enabled = []() {
+                char const *env = std::getenv("DEMO_PERF_COUNTERS");
+                return env && std::atoi(env) != 0;
+            }();
+            return enabled;
+        }
+    }
+
+    class Profiler {
+
+    public:
+
+        Profiler()
+        {
+            char const *env = std::getenv("DEMO_PROFILE");
+            if (!env || !*env)
+                return;
+            m_output = env;
+            int hz = 1000;
+            if (char const *envHz = std::getenv("DEMO_PROFILE_HZ"))
+                hz = std::max(1, std::atoi(envHz));
+            std::size_t nStacks = 32768;
+            if (char const *envStacks = std::getenv("DEMO_PROFILE_STACKS"))
+                nStacks = std::max(1, std::atoi(envStacks));
+
+            auto &state = detail::profilerState();
+            // Power of 2 for the probing of the table
+            std::size_t capacity = 1;
+            while (capacity < nStacks)
+                capacity *= 2;
+            m_stacks = std::make_unique<detail::ProfileStack[]>(capacity);
+            state.stacks   = m_stacks.get();
+            state.capacity = capacity;
+            state.dropped  = 0;
+            void *warmUp[1];
+            backtrace(warmUp, 1);
+
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = detail::profileHandler;
+            action.sa_flags   = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGPROF, &action, nullptr);
+
+            struct itimerval timer;
+            timer.it_interval.tv_sec  = 0;
+            timer.it_interval.tv_usec = std::max(1, 1000000 / hz);
+            timer.it_value = timer.it_interval;
+            setitimer(ITIMER_PROF, &timer, nullptr);
+        }
+
+        Profiler(Profiler const &) = delete;
+        Profiler &operator=(Profiler const &) = delete;
+
+        ~Profiler()
+        {
+            if (m_output.empty())
+                return;
+            stop();
+            write();
+            detail::profilerState().capacity = 0;
+        }
+
+        bool enabled() const { return !m_output.empty(); }
+
+    private:
+
+        void stop()
+        {
+            struct itimerval timer;
+            std::memset(&timer, 0, sizeof(timer));
+            setitimer(ITIMER_PROF, &timer, nullptr);
+            signal(SIGPROF, SIG_IGN);
+        }
+
+        void write() const
+        {
+            auto &state = detail::profilerState();
+            std::unordered_map<void*, std::string> names;
+            std::map<std::string, std::size_t> folded;
+            std::size_t total = 0;
+            for (std::size_t i = 0; i != state.capacity; ++i) {
+                auto const &entry = m_stacks[i];
+                if (entry.state.load(std::memory_order_acquire) != 2)
+                    continue;
+                std::string stack = entry.stage;
+                // The two innermost frames are the handler and the 
+                // signal trampoline
+                for (int f = entry.depth - 1; f >= 2; --f) {
+                    void *address = entry.frames[f];
+                    auto pos = names.find(address);
+                    if (pos == names.end())
+                        pos = names.emplace(address, detail::frameName(address)).first;
+                    stack += ';';
+                    stack += pos->second;
+                }
+                std::size_t const count = entry.count.load(std::memory_order_relaxed);
+                folded[stack] += count;
+                total += count;
+            }
+            std::ofstream out(m_output);
+            for (auto const &[stack, count] : folded)
+                out << stack << ' ' << count << '\n';
+            std::cerr << "Profiler: " << total << " samples (" 
+                      << folded.size() << " stacks) written in " << m_output;
+            if (std::size_t const dropped = state.dropped)
+                std::cerr << " (" << dropped << " dropped, increase "
+                          << "DEMO_PROFILE_STACKS)";
+            std::cerr << '\n';
+        }
+
+        std::string                             m_output;
+        std::unique_ptr<detail::ProfileStack[]> m_stacks;
+    };
+
+    // Pipeline stage the samples are attributed to during the lifetime
+    // of the object, with its hardware counters if enabled. The name 
+    // must outlive the object (a string literal in general).
+    class ProfileStage {
+
+    public:
+
+        explicit ProfileStage(char const *name)
+            :m_previous(detail::profilerState().stage.exchange(name))
+        {
+            if (detail::perfCountersEnabled()) {
+                m_counters = std::make_unique<PerfCounters>();
+                m_counters->start();
+            }
+        }
+
+        ProfileStage(ProfileStage const &) = delete;
+        ProfileStage &operator=(ProfileStage const &) = delete;
+
+        ~ProfileStage()
+        {
+            char const *name = detail::profilerState().stage.exchange(m_previous);
+            if (m_counters)
+                std::cerr << "[" << name << "] " << m_counters->stop() << '\n';
+        }
+
+    private:
+
+        char const                   *m_previous;
+        std::unique_ptr<PerfCounters> m_counters;
+    };
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * QED model of main.cpp (muon and photon) shared by the other MARTY
+ * programs of this demo.
+ *
+ * main.cpp builds the model step by step with the references to the
+ * manual, the programs extending it or benchmarking it start from the
+ * functions below. The model is never refreshed here: programs add
+ * their own particles and interactions first and call model.refresh()
+ * once (see main.cpp).
+ */
+#ifndef DEMO_QED_MODEL_H_INCLUDED
+#define DEMO_QED_MODEL_H_INCLUDED
+
+#include "marty.h"
+
+namespace demo {
+
+    // Adds the U(1) em gauge group with coupling e, initializes the
+    // model and fixes the gauge of the photon, renamed A. Other gauge
+    // groups must be added to the model before the call.
+    inline void initQed(
+            mty::Model      &model,
+            csl::Expr const &e     = csl::constant_s("e"),
+            mty::gauge::Type gauge = mty::gauge::Type::Feynman
+            )
+    {
+        model.addGaugedGroup(mty::group::Type::U1, "em", e);
+        model.init();
+
+        model.renameParticle("A_em", "A");
+        model.setGaugeChoice("A", gauge);
+    }
+
+    // Muon of charge -1 and mass m_mu, not added to the model so that
+    // its representation under other groups can be set first
+    inline mty::Particle muonParticle(mty::Model &model)
+    {
+        mty::Particle muon = mty::diracfermion_s("mu ; \\mu", model);
+        muon->setGroupRep("em", -1);
+        muon->setMass(csl::constant_s("m_mu"));
+        return muon;
+    }
+
+    // QED model of main.cpp with the photon in the given gauge, returns
+    // the muon
+    inline mty::Particle buildQedModel(
+            mty::Model      &model,
+            mty::gauge::Type gauge = mty::gauge::Type::Feynman
+            )
+    {
+        initQed(model, csl::constant_s("e"), gauge);
+        mty::Particle muon = muonParticle(model);
+        model.addParticle(muon);
+        return muon;
+    }
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * Local store of the symbolic results of the MARTY programs of this
+ * demo, indexed by process signature.
+ *
+ * A signature is made of a fingerprint of the model (hash of its full
+ * printed form: particles, gauge groups, interactions, ...), the
+ * process insertions, the loop order and the options of the
+ * calculation. Each entry records where the result was generated (the
+ * library and the function name) and the printed expression is kept
+ * next to the index for inspection.
+ *
+ * Expressions cannot be read back into MARTY, so a program finding its
+ * signature in the store re-uses the generated function instead of
+ * recomputing it. The signature does not cover the code of the program
+ * itself, so results are always recorded but found only when reuse is
+ * asked for with DEMO_REUSE_STORE=1: otherwise a program edited since
+ * its last run would silently keep its old results.
+ *
+ * The index is a text file, loaded once by each ResultStore. Readers
+ * take a shared lock on it and writers an exclusive one, so that any
+ * number of programs can read the store while another one adds its
+ * results.
+ */
+#ifndef DEMO_RESULT_STORE_H_INCLUDED
+#define DEMO_RESULT_STORE_H_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include "marty.h"
+
+namespace demo {
+
+    struct StoredResult {
+        std::string function; // Name of the generated function
+        std::string library;  // Library in which it was generated
+    };
+
+    class ResultStore {
+
+    public:
+
+        explicit ResultStore(std::string t_path = ".marty_store")
+            :m_path(std::move(t_path)),
+            m_reuse(reuseEnabled())
+        {
+            std::filesystem::create_directories(m_path);
+            load();
+        }
+
+        // Signature of a calculation. The process is given as written
+        // in the insertions, for example "mu -> mu A".
+        static std::string signature(
+                mty::Model  const &model,
+                std::string const &process,
+                std::string const &order,
+                std::string const &options = ""
+                )
+        {
+            std::ostringstream modelOut;
+            modelOut << model;
+            std::ostringstream out;
+            out << std::hex << std::setw(16) << std::setfill('0')
+                << hash(modelOut.str()) << '|' << process << '|'
+                << order << '|' << options;
+            return out.str();
+        }
+
+        // Result stored for the signature, if reuse is enabled and the
+        // generated function still exists in its library
+        std::optional<StoredResult> find(std::string const &sig) const
+        {
+            if (!m_reuse)
+                return std::nullopt;
+            auto pos = m_index.find(sig);
+            if (pos == m_index.end())
+                return std::nullopt;
+            std::filesystem::path const header = 
+                std::filesystem::path(pos->second.library) 
+                / "include" / (pos->second.function + ".h");
+            if (!std::filesystem::exists(header))
+                return std::nullopt;
+            return pos->second;
+        }
+
+        // Records a result, the expression is printed in the store
+        void insert(
+                std::string  const &sig,
+                StoredResult const &result,
+                csl::Expr    const &expr
+                )
+        {
+            std::ostringstream name;
+            name << std::hex << hash(sig) << ".txt";
+            std::ofstream(m_path + "/" + name.str()) << sig << '\n' << expr << '\n';
+
+            LockedFile index(indexPath(), LOCK_EX);
+            std::ostringstream line;
+            line << sig << '\t' << result.function << '\t'
+                 << result.library << '\n';
+            std::string const str = line.str();
+            if (write(index.fd, str.data(), str.size()) < 0)
+                std::perror("ResultStore: write");
+            m_index[sig] = result;
+        }
+
+    private:
+
+        // File descriptor holding a flock() for its lifetime
+        struct LockedFile {
+            int fd;
+            LockedFile(std::string const &path, int operation)
+                :fd(open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644))
+            {
+                if (fd >= 0)
+                    flock(fd, operation);
+            }
+            ~LockedFile()
+            {
+                if (fd >= 0) {
+                    flock(fd, LOCK_UN);
+                    close(fd);
+                }
+            }
+        };
+
+        static bool reuseEnabled()
+        {
+            char const *env = std::getenv("DEMO_REUSE_STORE");
+            return env && std::atoi(env) != 0;
+        }
+
+        // 64-bit FNV-1a hash
+        static std::uint64_t hash(std::string const &str)
+        {
+            std::uint64_t h = 14695981039346656037ull;
+            for (unsigned char c : str) {
+                h ^= c;
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        std::string indexPath() const
+        {
+            return m_path + "/index";
+        }
+
+        void load()
+        {
+            LockedFile lock(indexPath(), LOCK_SH);
+            std::ifstream in(indexPath());
+            std::string line;
+            while (std::getline(in, line)) {
+                std::size_t const first  = line.find('\t');
+                std::size_t const second = line.find('\t', first + 1);
+                if (second == std::string::npos)
+                    continue;
+                m_index[line.substr(0, first)] = {
+                    line.substr(first + 1, second - first - 1),
+                    line.substr(second + 1)
+                };
+            }
+        }
+
+        std::string                                   m_path;
+        bool                                          m_reuse;
+        std::unordered_map<std::string, StoredResult> m_index;
+    };
+}
+
+#endif
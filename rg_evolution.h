@@ -0,0 +1,148 @@
+/*
+ * Leading-log QED evolution of the dipole Wilson coefficients from the
+ * matching scale down to a low scale (m_mu for (g-2)).
+ *
+ * At one loop in the low-energy theory
+ *     dalpha/dln(mu) = -2*b0 * alpha^2 / (4*pi)
+ *     dC/dln(mu)     = gamma0 * alpha / (4*pi) * C
+ * with b0 = -4/3 * sum_f Q_f^2 for the charged fermions below the 
+ * matching scale, and gamma0 the anomalous dimension of the 
+ * coefficients. The magnetic and electric dipoles do not mix in QED and
+ * have the same anomalous dimension, so the evolution of all the 
+ * coefficients of a point is a single factor
+ *     C(mu) = (alpha(mu) / alpha(mu_high))^(-gamma0 / (2*b0)) * C(mu_high)
+ *
+ * DipoleEvolution applies this factor to batches of coefficient 
+ * vectors, each point having its own matching scale. evolveRK4() 
+ * integrates the same equations numerically for all the points at once
+ * and is kept to check the analytic solution (or for anomalous 
+ * dimensions that do not allow one).
+ *
+ * The header is self-contained (with execution.h), copy it next to the
+ * scripts using it.
+ */
+#ifndef DEMO_RG_EVOLUTION_H_INCLUDED
+#define DEMO_RG_EVOLUTION_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include "execution.h"
+
+namespace demo {
+
+    // Anomalous dimension of a dipole coefficient of a fermion of charge
+    // Q, for operators normalized as \bar{f} sigma^{mu,nu} f F_{mu,nu} 
+    // (Jenkins, Manohar, Stoffer 2017): 10*Q^2 from the operator 
+    // insertion and -b0 from the normalization of the photon field
+    inline double dipoleAnomalousDimension(double Q, double b0)
+    {
+        return 10*Q*Q - b0;
+    }
+
+    class DipoleEvolution {
+
+    public:
+
+        // alphaLow is the coupling at the low scale muLow
+        DipoleEvolution(
+                double t_b0,
+                double t_gamma0,
+                double t_alphaLow,
+                double t_muLow
+                )
+            :m_b0(t_b0),
+            m_gamma0(t_gamma0),
+            m_alphaLow(t_alphaLow),
+            m_muLow(t_muLow)
+        {}
+
+        double b0() const { return m_b0; }
+        double gamma0() const { return m_gamma0; }
+        double muLow() const { return m_muLow; }
+
+        // One-loop running coupling
+        double alpha(double mu) const
+        {
+            return m_alphaLow 
+                / (1 + 2*m_b0*m_alphaLow/(4*M_PI) * std::log(mu / m_muLow));
+        }
+
+        // C(muLow) = factor(muHigh) * C(muHigh)
+        double factor(double muHigh) const
+        {
+            return std::pow(m_alphaLow / alpha(muHigh), -m_gamma0 / (2*m_b0));
+        }
+
+        // Evolves the coefficients of n points down to muLow, 
+        // coefficients[i*nOps + k] being the k-th coefficient of point i
+        // at its matching scale muHigh[i]. T is double or complex_t.
+        template<class T>
+        void evolve(
+                double const *muHigh,
+                std::size_t   n,
+                std::size_t   nOps,
+                T            *coefficients
+                ) const
+        {
+            parallelFor(n, [&](std::size_t begin, std::size_t end, unsigned) {
+                for (std::size_t i = begin; i != end; ++i) {
+                    double const f = factor(muHigh[i]);
+                    for (std::size_t k = 0; k != nOps; ++k)
+                        coefficients[i*nOps + k] *= f;
+                }
+            });
+        }
+
+        // Same with a fourth-order Runge-Kutta integration of (alpha, C)
+        // in nSteps steps. All the points advance together, the step in
+        // ln(mu) of each point being its range divided by nSteps.
+        template<class T>
+        void evolveRK4(
+                double const *muHigh,
+                std::size_t   n,
+                std::size_t   nOps,
+                T            *coefficients,
+                std::size_t   nSteps = 100
+                ) const
+        {
+            // d(alpha, ln C)/dln(mu), only ln C is needed as the 
+            // evolution is diagonal
+            auto derivative = [&](double a, double &da, double &dlnC) {
+                da   = -2*m_b0*a*a/(4*M_PI);
+                dlnC = m_gamma0*a/(4*M_PI);
+            };
+            parallelFor(n, [&](std::size_t begin, std::size_t end, unsigned) {
+                std::size_t const size = end - begin;
+                std::vector<double> a(size), lnC(size, 0.), h(size);
+                for (std::size_t i = 0; i != size; ++i) {
+                    a[i] = alpha(muHigh[begin + i]);
+                    h[i] = std::log(m_muLow / muHigh[begin + i]) / nSteps;
+                }
+                for (std::size_t step = 0; step != nSteps; ++step)
+                    for (std::size_t i = 0; i != size; ++i) {
+                        double da1, dc1, da2, dc2, da3, dc3, da4, dc4;
+                        derivative(a[i], da1, dc1);
+                        derivative(a[i] + h[i]/2*da1, da2, dc2);
+                        derivative(a[i] + h[i]/2*da2, da3, dc3);
+                        derivative(a[i] + h[i]*da3, da4, dc4);
+                        a[i]   += h[i]/6 * (da1 + 2*da2 + 2*da3 + da4);
+                        lnC[i] += h[i]/6 * (dc1 + 2*dc2 + 2*dc3 + dc4);
+                    }
+                for (std::size_t i = 0; i != size; ++i) {
+                    double const f = std::exp(lnC[i]);
+                    for (std::size_t k = 0; k != nOps; ++k)
+                        coefficients[(begin + i)*nOps + k] *= f;
+                }
+            });
+        }
+
+    private:
+
+        double m_b0;
+        double m_gamma0;
+        double m_alphaLow;
+        double m_muLow;
+    };
+}
+
+#endif
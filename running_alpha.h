@@ -0,0 +1,96 @@
+/*
+ * Tabulated running coupling alpha(Q^2) for space-like momenta
+ * q^2 = -Q^2 < 0,
+ *     alpha(Q^2) = alpha / (1 - Pihat(-Q^2))
+ * with Pihat(q^2) = Pi(q^2) - Pi(0) the renormalized vacuum
+ * polarization.
+ *
+ * Pihat is evaluated once on a logarithmic grid in Q^2 and the table is
+ * then queried in constant time by linear interpolation in log(Q^2), so
+ * that scans needing the running coupling do not evaluate the loop
+ * functions at every point.
+ *
+ * The header is self-contained (with execution.h), copy it next to the
+ * scripts using it.
+ */
+#ifndef DEMO_RUNNING_ALPHA_H_INCLUDED
+#define DEMO_RUNNING_ALPHA_H_INCLUDED
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "execution.h"
+
+namespace demo {
+
+    class RunningAlphaTable {
+
+    public:
+
+        // piHat(Q2) must return Pihat(-Q2). It is evaluated on forked 
+        // workers (see processFor()) as it typically calls LoopTools.
+        // The table needs at least two points and Q2Min < Q2Max.
+        template<class PiHat>
+        RunningAlphaTable(
+                double        t_alpha,
+                double        Q2Min,
+                double        Q2Max,
+                std::size_t   nPoints,
+                PiHat       &&piHat
+                )
+            :m_alpha(t_alpha),
+            m_logQ2Min(std::log(Q2Min)),
+            m_invStep(inverseStep(Q2Min, Q2Max, nPoints)),
+            m_values(nPoints)
+        {
+            SharedArray<double> values(nPoints);
+            double const step = 1. / m_invStep;
+            processFor(nPoints, [&](std::size_t begin, std::size_t end, unsigned) {
+                for (std::size_t i = begin; i != end; ++i) {
+                    double const Q2 = std::exp(m_logQ2Min + i*step);
+                    values[i] = m_alpha / (1 - piHat(Q2));
+                }
+            });
+            std::copy(values.begin(), values.end(), m_values.begin());
+        }
+
+        // Coupling at zero momentum transfer
+        double alpha() const { return m_alpha; }
+
+        // alpha(Q^2), Q^2 = -q^2 > 0. Values outside of the table are 
+        // clamped to its first and last points.
+        double operator()(double Q2) const
+        {
+            double const x = (std::log(Q2) - m_logQ2Min) * m_invStep;
+            if (!(x > 0))
+                return m_values.front();
+            std::size_t const i = static_cast<std::size_t>(x);
+            if (i + 1 >= m_values.size())
+                return m_values.back();
+            double const t = x - i;
+            return (1 - t) * m_values[i] + t * m_values[i + 1];
+        }
+
+    private:
+
+        static double inverseStep(
+                double      Q2Min, 
+                double      Q2Max, 
+                std::size_t nPoints
+                )
+        {
+            if (nPoints < 2 || !(Q2Min > 0 && Q2Min < Q2Max))
+                throw std::runtime_error(
+                        "RunningAlphaTable: needs at least two points "
+                        "and 0 < Q2Min < Q2Max");
+            return (nPoints - 1) / (std::log(Q2Max) - std::log(Q2Min));
+        }
+
+        double              m_alpha;
+        double              m_logQ2Min;
+        double              m_invStep;
+        std::vector<double> m_values;
+    };
+}
+
+#endif
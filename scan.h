@@ -0,0 +1,127 @@
+/*
+ * Small helpers shared by the parameter scan scripts (scan_*.cpp).
+ *
+ * Like execution.h, the header must be copied next to the scripts in
+ * the script directory of the generated library, together with
+ * execution.h and kinematics.h that it includes.
+ */
+#ifndef DEMO_SCAN_H_INCLUDED
+#define DEMO_SCAN_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "execution.h"
+#include "kinematics.h"
+
+namespace demo {
+
+    // Fine-structure constant and muon mass (in GeV) of the scans
+    constexpr double alphaQed = 1./137;
+    constexpr double muonMass = 0.1;
+
+    // Parameters shared by the (g-2) scans: electric charge and muon
+    // mass, on-shell muons and photon, finite part of the integrals
+    template<class Params>
+    void setOnShellVertex(
+            Params &params, 
+            double  alpha = alphaQed, 
+            double  m     = muonMass
+            )
+    {
+        params.e = std::sqrt(4*M_PI*alpha);
+        params.m_mu = m;
+        setVertexKinematics(params, m);
+        params.Finite = 1;
+    }
+
+    // Grid size given as argument i of the command line, def when it is
+    // absent. Returns 0 for anything but a positive integer, that the
+    // scans reject, instead of letting a negative value wrap around.
+    inline std::size_t gridSizeArgument(
+            int         argc,
+            char const *argv[],
+            int         i,
+            std::size_t def
+            )
+    {
+        if (argc <= i)
+            return def;
+        char *end;
+        long const value = std::strtol(argv[i], &end, 10);
+        return (end != argv[i] && *end == '\0' && value > 0) ? value : 0;
+    }
+
+    // As in example_demolib.cpp, (g-2) = -8m/e * C so a_mu = -4m/e * C
+    // for a coefficient C of the magnetic operator
+    inline double magneticToAmu(double e, double m)
+    {
+        return -4*m/e;
+    }
+
+    // processFor() over [0, n) where each worker calls f(begin, end) on
+    // batches of at most batchSize points of its chunk and clear() after
+    // each batch. Scans use it with the clearcache() of LoopTools, whose
+    // cache grows with every new set of masses.
+    template<class Func, class Clear>
+    void processForBatches(
+            std::size_t n, 
+            std::size_t batchSize, 
+            Func      &&f, 
+            Clear     &&clear
+            )
+    {
+        processFor(n, [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t i = begin; i < end; i += batchSize) {
+                f(i, std::min(end, i + batchSize));
+                clear();
+            }
+        });
+    }
+
+    // Value i of a logarithmic grid of n points in [min, max]
+    inline double logGrid(std::size_t i, std::size_t n, double min, double max)
+    {
+        if (n < 2)
+            return min;
+        return min * std::pow(max / min, double(i) / (n - 1));
+    }
+
+    // Simpson integration of f over [a, b] with n (even) intervals, used
+    // to evaluate the exact one-loop formulas the scans are compared to
+    template<class Func>
+    double simpson(Func &&f, double a, double b, int n = 2000)
+    {
+        double const h = (b - a) / n;
+        double sum = f(a) + f(b);
+        for (int i = 1; i != n; ++i)
+            sum += ((i % 2) ? 4 : 2) * f(a + i*h);
+        return sum * h / 3;
+    }
+
+    // For a contribution proportional to the square of a coupling g,
+    // fills the plane plane[i*nCoupling + j] = g_j^2 * column[i] where
+    // column[i] is the contribution at g = 1 for the i-th mass and g_j
+    // the j-th coupling of the scan.
+    template<class Column, class Coupling>
+    std::vector<double> quadraticCouplingPlane(
+            Column const &column,
+            std::size_t   nCoupling,
+            Coupling    &&coupling
+            )
+    {
+        std::size_t const nMass = column.size();
+        std::vector<double> plane(nMass * nCoupling);
+        parallelFor(nMass, [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t i = begin; i != end; ++i)
+                for (std::size_t j = 0; j != nCoupling; ++j) {
+                    double const g = coupling(j);
+                    plane[i*nCoupling + j] = g*g * column[i];
+                }
+        });
+        return plane;
+    }
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "bsmlib.h"
+#include "execution.h"
+#include "kinematics.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace bsmlib;
+
+// Exact one-loop scalar contribution to a_mu = (g-2)/2, used to check
+// the values of the generated function
+double amuScalarExact(double y, double m, double mS)
+{
+    double const r = mS*mS / (m*m);
+    return y*y / (8*M_PI*M_PI) * demo::simpson([&](double x) {
+        return x*x*(2 - x) / (x*x + (1 - x)*r);
+    }, 0, 1);
+}
+
+int main(int argc, char const *argv[]) {
+
+    // Grid size, can be given on the command line
+    std::size_t const nMass     = demo::gridSizeArgument(argc, argv, 1, 200);
+    std::size_t const nCoupling = demo::gridSizeArgument(argc, argv, 2, 200);
+    if (nMass == 0 || nCoupling == 0) {
+        // The check below reads the last coupling of a mass of the plane
+        std::cerr << "usage: " << argv[0] << " [nMass] [nCoupling]"
+                  << " (grid sizes must be positive)\n";
+        return 1;
+    }
+    double const mSMin = 1e-2, mSMax = 1e3;
+    double const yMin  = 1e-4, yMax  = 1;
+
+    param_t params;
+    double const m = demo::muonMass;
+    demo::setOnShellVertex(params, demo::alphaQed, m);
+    setlambda(0);
+    double const toAmu = demo::magneticToAmu(params.e, m);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Scan of the (m_S, y) plane
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // The coefficient comes from diagrams with two Yukawa vertices so it
+    // is exactly proportional to y^2, while the loop integrals depend
+    // only on m_S. The generated function is then called once per mass
+    // with y = 1, and the whole plane is obtained by rescaling.
+    //
+    // LoopTools keeps a global cache of integrals and is not thread-safe,
+    // the mass column is therefore evaluated in worker processes. Every 
+    // mass is new to the cache, it is cleared after each batch to keep 
+    // it small.
+    auto start = std::chrono::steady_clock::now();
+
+    params.y = 1;
+    demo::SharedArray<double> amuPerY2(nMass);
+    demo::processForBatches(nMass, 1024, [&](std::size_t begin, std::size_t end) {
+        param_t local = params;
+        for (std::size_t i = begin; i != end; ++i) {
+            local.m_S = demo::logGrid(i, nMass, mSMin, mSMax);
+            amuPerY2[i] = toAmu * mu_magnetic_scalar(local).real();
+        }
+    }, clearcache);
+
+    std::vector<double> plane = demo::quadraticCouplingPlane(
+            amuPerY2, nCoupling, [&](std::size_t j) {
+                return demo::logGrid(j, nCoupling, yMin, yMax);
+            });
+
+    std::chrono::duration<double> const elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << "######################################\n";
+    std::cout << "####  SCALAR CONTRIBUTION TO (g-2)\n";
+    std::cout << "######################################\n\n";
+    // Only the nMass points are evaluated, the couplings rescale them
+    std::cout << nMass << " evaluations in "
+              << elapsed.count() << " s on " << demo::workerCount()
+              << " workers ("
+              << nMass / elapsed.count() << " evaluations/s)\n";
+    std::cout << nMass * nCoupling << " points of the plane by rescaling"
+              << " in " << nCoupling << " couplings\n\n";
+
+    // Check one point of the plane against the exact result
+    std::size_t const iCheck = nMass / 2;
+    double const mSCheck = demo::logGrid(iCheck, nMass, mSMin, mSMax);
+    std::cout << "Check for m_S = " << mSCheck << ", y = " << yMax << ":\n";
+    std::cout << "Delta a_mu = " << plane[iCheck*nCoupling + nCoupling - 1]
+              << std::endl;
+    std::cout << "(should be equal to "
+              << amuScalarExact(yMax, m, mSCheck) << ")\n";
+
+    std::ofstream out("scan_bsm_scalar.dat");
+    out << "# m_S  y  Delta_a_mu\n";
+    for (std::size_t i = 0; i != nMass; ++i)
+        for (std::size_t j = 0; j != nCoupling; ++j)
+            out << demo::logGrid(i, nMass, mSMin, mSMax) << ' '
+                << demo::logGrid(j, nCoupling, yMin, yMax) << ' '
+                << plane[i*nCoupling + j] << '\n';
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "darklib.h"
+#include "execution.h"
+#include "histogram.h"
+#include "kinematics.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace darklib;
+
+// Exact one-loop dark photon contribution to a_mu = (g-2)/2, used to
+// check the values of the generated function
+double amuDarkExact(double eps, double alpha, double m, double mAp)
+{
+    double const r = mAp*mAp / (m*m);
+    return eps*eps * alpha / (2*M_PI) * demo::simpson([&](double z) {
+        return 2*z*(1 - z)*(1 - z) / ((1 - z)*(1 - z) + r*z);
+    }, 0, 1);
+}
+
+int main(int argc, char const *argv[]) {
+
+    // Grid size and bound on Delta a_mu, can be given on the command
+    // line. Points with a contribution above the bound are excluded.
+    std::size_t const nMass = demo::gridSizeArgument(argc, argv, 1, 200);
+    std::size_t const nEps  = demo::gridSizeArgument(argc, argv, 2, 200);
+    double const amuMax     = (argc > 3) ? std::atof(argv[3]) : 5e-9;
+    if (nMass == 0 || nEps == 0) {
+        // The check below reads the last coupling of a mass of the plane
+        std::cerr << "usage: " << argv[0] << " [nMass] [nEps] [amuMax]"
+                  << " (grid sizes must be positive)\n";
+        return 1;
+    }
+    double const mApMin  = 1e-3, mApMax  = 10;
+    double const epsMin  = 1e-5, epsMax  = 1e-1;
+
+    param_t params;
+    double const alpha = demo::alphaQed;
+    double const m     = demo::muonMass;
+    demo::setOnShellVertex(params, alpha, m);
+    setlambda(0);
+    double const toAmu = demo::magneticToAmu(params.e, m);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Scan of the (eps, m_Ap) plane
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // The dark photon couples with eps*e at both muon vertices so the
+    // coefficient is exactly proportional to eps^2: one call per mass
+    // with eps = 1, then the plane is obtained by rescaling (see
+    // scan_bsm_scalar.cpp).
+    auto start = std::chrono::steady_clock::now();
+
+    params.eps = 1;
+    demo::SharedArray<double> amuPerEps2(nMass);
+    demo::processForBatches(nMass, 1024, [&](std::size_t begin, std::size_t end) {
+        param_t local = params;
+        for (std::size_t i = begin; i != end; ++i) {
+            local.m_Ap = demo::logGrid(i, nMass, mApMin, mApMax);
+            amuPerEps2[i] = toAmu * mu_magnetic_dark(local).real();
+        }
+    }, clearcache);
+
+    std::vector<double> plane = demo::quadraticCouplingPlane(
+            amuPerEps2, nEps, [&](std::size_t j) {
+                return demo::logGrid(j, nEps, epsMin, epsMax);
+            });
+
+    std::chrono::duration<double> const elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << "######################################\n";
+    std::cout << "####  DARK PHOTON CONTRIBUTION TO (g-2)\n";
+    std::cout << "######################################\n\n";
+    // Only the nMass points are evaluated, the mixings rescale them
+    std::cout << nMass << " evaluations in "
+              << elapsed.count() << " s on " << demo::workerCount()
+              << " workers ("
+              << nMass / elapsed.count() << " evaluations/s)\n";
+    std::cout << nMass * nEps << " points of the plane by rescaling"
+              << " in " << nEps << " mixings\n\n";
+
+    std::size_t const iCheck = nMass / 2;
+    double const mApCheck = demo::logGrid(iCheck, nMass, mApMin, mApMax);
+    std::cout << "Check for m_Ap = " << mApCheck << ", eps = " << epsMax << ":\n";
+    std::cout << "Delta a_mu = " << plane[iCheck*nEps + nEps - 1]
+              << std::endl;
+    std::cout << "(should be equal to "
+              << amuDarkExact(epsMax, alpha, m, mApCheck) << ")\n";
+
+    // Distribution of log10(Delta a_mu) over the plane, filled by all
+    // the workers at once
+    demo::ConcurrentHistogram distribution(100, -20, 0);
+    demo::parallelFor(plane.size(), [&](std::size_t begin, std::size_t end, unsigned worker) {
+        for (std::size_t i = begin; i != end; ++i)
+            distribution.fill(worker, std::log10(std::abs(plane[i])));
+    });
+    std::ofstream outDistribution("scan_dark_photon_distribution.dat");
+    outDistribution << "# log10(Delta_a_mu) bin edges, count, error\n";
+    distribution.write(outDistribution);
+
+    // Points with a contribution larger than amuMax are flagged excluded
+    std::ofstream out("scan_dark_photon.dat");
+    out << "# m_Ap  eps  Delta_a_mu  excluded\n";
+    for (std::size_t i = 0; i != nMass; ++i)
+        for (std::size_t j = 0; j != nEps; ++j) {
+            double const amu = plane[i*nEps + j];
+            out << demo::logGrid(i, nMass, mApMin, mApMax) << ' '
+                << demo::logGrid(j, nEps, epsMin, epsMax) << ' '
+                << amu << ' ' << (std::abs(amu) > amuMax) << '\n';
+        }
+
+    return 0;
+}
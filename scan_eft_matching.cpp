@@ -0,0 +1,160 @@
+#include "eftlib_matching_batch.h"
+#include "eftlib_running.h"
+#include "execution.h"
+#include "kinematics.h"
+#include "rg_evolution.h"
+#include "scan.h"
+
+// Include looptools to call setlambda()
+#include "clooptools.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace eftlib;
+
+// Exact one-loop contribution of a neutral scalar with scalar and
+// pseudoscalar couplings to a_mu = (g-2)/2, used to check the matching
+double amuMatchingExact(double cS, double cP, double m, double M)
+{
+    double const r = M*M / (m*m);
+    return 1 / (8*M_PI*M_PI) * demo::simpson([&](double x) {
+        return (cS*cS*x*x*(2 - x) - cP*cP*x*x*x) / (x*x + (1 - x)*r);
+    }, 0, 1);
+}
+
+int main(int argc, char const *argv[]) {
+
+    // Number of UV parameter points, can be given on the command line
+    std::size_t const nPoints = demo::gridSizeArgument(argc, argv, 1, 10000);
+    if (nPoints == 0) {
+        std::cerr << "usage: " << argv[0] << " [nPoints]"
+                  << " (the number of points must be positive)\n";
+        return 1;
+    }
+    double const MMin = 1, MMax = 1e3;
+
+    param_t params;
+    double const alpha = demo::alphaQed;
+    double const m     = demo::muonMass;
+    demo::setOnShellVertex(params, alpha, m);
+    setlambda(0);
+    double const toAmu = demo::magneticToAmu(params.e, m);
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Beta function of the low-energy theory
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // The divergence of the vacuum polarization Pi = -C_g/q^2 (see 
+    // example_running_alpha.cpp) is p/eps with p = b0*alpha/(4*pi), 
+    // the renormalization of the coupling then gives 
+    // dalpha/dln(mu) = -2*b0*alpha^2/(4*pi).
+    param_t pole = params;
+    demo::setTwoPointKinematics(pole, -m*m); // Irrelevant for the pole
+    pole.Finite = 0;
+    setlambda(-1);
+    double const piPole = -photon_self_e_gterm(pole).real() / pole.s_11;
+    setlambda(0);
+    double const b0 = piPole * 4*M_PI / alpha;
+    // The muon is the only charged fermion below the matching scale
+    double const gamma0 = demo::dipoleAnomalousDimension(-1, b0);
+    demo::DipoleEvolution evolution(b0, gamma0, alpha, m);
+
+    // Random UV points: M_Phi on a logarithmic scale, couplings in 
+    // [-1, 1]. The seed is fixed so that runs can be compared.
+    std::vector<param_t> points(nPoints, params);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (auto &point : points) {
+        point.M_Phi = MMin * std::pow(MMax / MMin, uniform(gen));
+        point.c_S   = 2*uniform(gen) - 1;
+        point.c_P   = 2*uniform(gen) - 1;
+    }
+
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+    //  Low-energy coefficients of the batch
+    /////////////////////////////////////////
+    /////////////////////////////////////////
+
+    // The fused kernel returns matching_size coefficients per point. 
+    // LoopTools is not thread-safe so the batch is split between worker
+    // processes, each one clearing its cache of integrals between 
+    // sub-batches.
+    auto start = std::chrono::steady_clock::now();
+
+    demo::SharedArray<complex_t> coefficients(nPoints * matching_size);
+    demo::processForBatches(nPoints, 1024, [&](std::size_t begin, std::size_t end) {
+        matching_batch(
+                points.data() + begin, 
+                end - begin, 
+                coefficients.data() + begin*matching_size
+                );
+    }, clearcache);
+
+    std::chrono::duration<double> const elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    // Running of all the coefficients from M_Phi down to m_mu
+    start = std::chrono::steady_clock::now();
+
+    std::vector<double> muHigh(nPoints);
+    for (std::size_t i = 0; i != nPoints; ++i)
+        muHigh[i] = points[i].M_Phi;
+    std::vector<complex_t> evolved(coefficients.begin(), coefficients.end());
+    evolution.evolve(muHigh.data(), nPoints, matching_size, evolved.data());
+
+    std::chrono::duration<double> const elapsedRunning
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << "######################################\n";
+    std::cout << "####  MATCHING OF A HEAVY SCALAR\n";
+    std::cout << "######################################\n\n";
+    std::cout << nPoints << " points in " << elapsed.count() << " s on "
+              << demo::workerCount() << " workers ("
+              << nPoints / elapsed.count() << " points/s)\n";
+    std::cout << "Running to m_mu in " << elapsedRunning.count() << " s\n\n";
+
+    std::cout << "b0 = " << b0 << " (should be equal to " << -4./3 << ")\n";
+    std::cout << "gamma0 = " << gamma0 << "\n\n";
+
+    // Check the first point against the exact result. The magnetic 
+    // coefficient is the first of the kernel (see eftlib_matching_batch.h)
+    param_t const &check = points[0];
+    std::cout << "Check for M_Phi = " << check.M_Phi << ", c_S = " 
+              << check.c_S << ", c_P = " << check.c_P << ":\n";
+    std::cout << "Delta a_mu = " << toAmu * coefficients[0].real() 
+              << std::endl;
+    std::cout << "(should be equal to "
+              << amuMatchingExact(check.c_S, check.c_P, m, check.M_Phi) 
+              << ")\n";
+    std::cout << "Delta a_mu after running to m_mu = " 
+              << toAmu * evolved[0].real() << std::endl;
+    std::vector<complex_t> checkRK4(
+            coefficients.begin(), coefficients.begin() + matching_size);
+    evolution.evolveRK4(muHigh.data(), 1, matching_size, checkRK4.data());
+    std::cout << "(should be equal to the numerical solution "
+              << toAmu * checkRK4[0].real() << ")\n";
+
+    // The electric dipole moment is |d_mu| = 2|C_E| with the 
+    // normalization of the operators of chromoMagneticOperator(). Both
+    // are written at the matching scale and after running to m_mu.
+    std::ofstream out("scan_eft_matching.dat");
+    out << "# M_Phi  c_S  c_P  Delta_a_mu  |d_mu|"
+        << "  Delta_a_mu(m_mu)  |d_mu|(m_mu)\n";
+    for (std::size_t i = 0; i != nPoints; ++i)
+        out << points[i].M_Phi << ' ' << points[i].c_S << ' ' 
+            << points[i].c_P << ' '
+            << toAmu * coefficients[i*matching_size].real() << ' '
+            << 2 * std::abs(coefficients[i*matching_size + 1]) << ' '
+            << toAmu * evolved[i*matching_size].real() << ' '
+            << 2 * std::abs(evolved[i*matching_size + 1]) << '\n';
+
+    return 0;
+}